@@ -0,0 +1,17 @@
+#ifndef _H_BENCH
+#define _H_BENCH
+
+#include "gfx.hpp"
+
+// Times fillRect() against SDL_FillRect on off-screen 16 and 32 bpp
+// surfaces, for the rectangle sizes a frame of the game is made of.
+void runFillBenchmark(unsigned long iterations);
+
+// Draws the same autopiloted frames with each render path and reports
+// per frame the bytes of rectangle fills, the commands recorded and the
+// time spent recording them apart from the time spent drawing them.
+// With dirtyRects the view repaints only what changed, as with
+// --dirty-rects; with VB_NULL nothing is presented.
+void runRenderBenchmark(unsigned long frames, unsigned seed, bool dirtyRects, VideoBackend backend);
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef _H_CLOCK
+#define _H_CLOCK
+
+#include <cstdint>
+
+#include "game.hpp"
+
+// Nanoseconds on a monotonic clock with an arbitrary start:
+// CLOCK_MONOTONIC on Linux, the performance counter with SDL2 elsewhere.
+std::int64_t monotonicNs();
+
+// Turns real time into whole fixed simulation steps without rounding.
+// A step of 1/SIM_RATE s is no whole number of nanoseconds, so time is
+// counted in units of 1/SIM_RATE ns instead, which makes a step exactly
+// STEP of them.
+class StepClock
+{
+public:
+	static constexpr std::int64_t STEP = 1000000000;
+	explicit StepClock(std::int64_t now) : last{now} {}
+	// adds the time up to now; a stall adds no more than MAX_FRAME_MS,
+	// so that the simulation does not try to catch up after it
+	void advance(std::int64_t now);
+	bool stepDue() const { return accumulator >= STEP; }
+	void step() { accumulator -= STEP; }
+	// nanoseconds of real time that no step has simulated yet
+	std::int64_t leftoverNs() const { return accumulator / SIM_RATE; }
+	// nanoseconds of real time until the next step is due, rounded up
+	std::int64_t untilStepNs() const { return (STEP - accumulator + SIM_RATE - 1) / SIM_RATE; }
+	// how far into the next step the clock is, for interpolating
+	double alpha() const { return double(accumulator) / STEP; }
+private:
+	static constexpr std::int64_t MAX_ADVANCE = std::int64_t(GameWorld::MAX_FRAME_MS * 1000000) * SIM_RATE;
+	std::int64_t last;
+	std::int64_t accumulator = 0;
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef _H_COLLIDE
+#define _H_COLLIDE
+
+#include <cstdint>
+
+#include "real.hpp"
+
+class CollisionBox
+{
+public:
+	Real x;
+	Real y;
+	Real w;
+	Real h;
+	bool collides(const CollisionBox &cb) const;
+	CollisionBox interpolate(const CollisionBox &prev, double alpha) const;
+};
+
+// Largest number of boxes collideMask() can test in one call.
+constexpr int COLLIDE_BATCH = 32;
+
+// Tests box against count boxes stored as separate coordinate arrays.
+// Bit k of the result is set when box collides with box k, with the
+// same edge rules as CollisionBox::collides().
+std::uint32_t collideMask(const Real *x, const Real *y, const Real *w, const Real *h,
+	int count, const CollisionBox &box);
+
+// Boxes kept as structure-of-arrays, indexed by slot, together with
+// their positions from the previous simulation step.
+template <int N>
+class BoxArrays
+{
+public:
+	alignas(32) Real x[N];
+	alignas(32) Real y[N];
+	alignas(32) Real w[N];
+	alignas(32) Real h[N];
+	alignas(32) Real prevX[N];
+	alignas(32) Real prevY[N];
+
+	CollisionBox box(int i) const
+	{
+		return CollisionBox{x[i], y[i], w[i], h[i]};
+	}
+
+	CollisionBox prevBox(int i) const
+	{
+		return CollisionBox{prevX[i], prevY[i], w[i], h[i]};
+	}
+
+	// stores a new box with no motion to interpolate from
+	void set(int i, const CollisionBox &cb)
+	{
+		x[i] = prevX[i] = cb.x;
+		y[i] = prevY[i] = cb.y;
+		w[i] = cb.w;
+		h[i] = cb.h;
+	}
+
+	void savePrevious(int i)
+	{
+		prevX[i] = x[i];
+		prevY[i] = y[i];
+	}
+
+	// boxes first .. first + count - 1 must not wrap past N
+	std::uint32_t collide(int first, int count, const CollisionBox &box) const
+	{
+		return collideMask(x + first, y + first, w + first, h + first, count, box);
+	}
+};
+
+#endif
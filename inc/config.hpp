@@ -0,0 +1,23 @@
+#ifndef _H_CONFIG
+#define _H_CONFIG
+
+constexpr int SCREEN_WIDTH = 320;
+constexpr int SCREEN_HEIGHT = 240;
+// the depth asked for; the screen keeps whatever 16 or 32 bpp mode the
+// display actually runs at
+#if defined(_BITTBOY)
+constexpr int SCREEN_BPP = 16;
+constexpr int FPS = 40;
+// frames in a row that may go undrawn when drawing cannot keep up
+constexpr int MAX_FRAME_SKIP = 3;
+#elif defined(__EMSCRIPTEN__)
+constexpr int SCREEN_BPP = 32;
+constexpr int FPS = 60;
+constexpr int MAX_FRAME_SKIP = 0;
+#else
+constexpr int SCREEN_BPP = 32;
+constexpr int FPS = 60;
+constexpr int MAX_FRAME_SKIP = 0;
+#endif
+
+#endif
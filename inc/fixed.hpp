@@ -0,0 +1,66 @@
+#ifndef _H_FIXED
+#define _H_FIXED
+
+#include <cstdint>
+
+// Signed Q16.16 fixed-point number, for targets without a usable FPU.
+// Values range over about +-32767 with a resolution of 1/65536.
+// Construction from int and double is implicit so that constants and
+// mixed expressions read the same as with double; conversion back is
+// explicit through toInt() and toDouble().
+class Fixed
+{
+public:
+	static constexpr int FRACTION_BITS = 16;
+	static constexpr std::int32_t ONE = 1 << FRACTION_BITS;
+	std::int32_t raw;
+
+	Fixed() = default;
+	constexpr Fixed(int v) : raw{v * ONE} {}
+	constexpr Fixed(double v) : raw{(std::int32_t)(v >= 0 ? v * ONE + 0.5 : v * ONE - 0.5)} {}
+
+	static constexpr Fixed fromRaw(std::int32_t raw)
+	{
+		Fixed f{};
+		f.raw = raw;
+		return f;
+	}
+
+	constexpr Fixed operator-() const { return fromRaw(-raw); }
+	Fixed &operator+=(Fixed o) { raw += o.raw; return *this; }
+	Fixed &operator-=(Fixed o) { raw -= o.raw; return *this; }
+	Fixed &operator*=(Fixed o) { return *this = *this * o; }
+	Fixed &operator/=(Fixed o) { return *this = *this / o; }
+
+	friend constexpr Fixed operator+(Fixed a, Fixed b) { return fromRaw(a.raw + b.raw); }
+	friend constexpr Fixed operator-(Fixed a, Fixed b) { return fromRaw(a.raw - b.raw); }
+	friend constexpr Fixed operator*(Fixed a, Fixed b)
+	{
+		return fromRaw((std::int32_t)(((std::int64_t)a.raw * b.raw) >> FRACTION_BITS));
+	}
+	friend constexpr Fixed operator/(Fixed a, Fixed b)
+	{
+		return fromRaw((std::int32_t)(((std::int64_t)a.raw << FRACTION_BITS) / b.raw));
+	}
+
+	friend constexpr bool operator==(Fixed a, Fixed b) { return a.raw == b.raw; }
+	friend constexpr bool operator!=(Fixed a, Fixed b) { return a.raw != b.raw; }
+	friend constexpr bool operator<(Fixed a, Fixed b) { return a.raw < b.raw; }
+	friend constexpr bool operator<=(Fixed a, Fixed b) { return a.raw <= b.raw; }
+	friend constexpr bool operator>(Fixed a, Fixed b) { return a.raw > b.raw; }
+	friend constexpr bool operator>=(Fixed a, Fixed b) { return a.raw >= b.raw; }
+
+	// rounds towards zero, like a cast from double
+	friend constexpr int toInt(Fixed v) { return v.raw / ONE; }
+	friend constexpr double toDouble(Fixed v) { return (double)v.raw / ONE; }
+	friend constexpr Fixed fabs(Fixed v) { return v.raw < 0 ? -v : v; }
+	// sine from a lookup table, angle in radians
+	friend Fixed sin(Fixed v);
+	// exact to the last bit, computed on the integer representation
+	friend Fixed sqrt(Fixed v);
+};
+
+Fixed sin(Fixed v);
+Fixed sqrt(Fixed v);
+
+#endif
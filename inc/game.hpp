@@ -1,168 +1,249 @@
 #ifndef _H_GAME
 #define _H_GAME
 
-#include <string>
-#include <memory>
-#include <random>
-#include <list>
-#include <SDL/SDL.h>
-
-#include "gfx.hpp"
+#include <cstdint>
+#include <vector>
+
+#include "config.hpp"
+#include "real.hpp"
+#include "ring.hpp"
+#include "collide.hpp"
+#include "rng.hpp"
+
+// simulation steps per second, independent of the draw rate
+#ifndef SIM_RATE
+#define SIM_RATE 120
+#endif
 
 class GameWorld;
 
-class CollisionBox
+enum InputButton
 {
-public:
-	double x;
-	double y;
-	double w;
-	double h;
-	void draw();
-	bool collides(const CollisionBox &cb);
+	IB_LEFT = 1 << 0,
+	IB_RIGHT = 1 << 1,
+	IB_JUMP = 1 << 2
 };
 
-class IPlatform
+// The buttons held at the end of a frame, plus every press and release
+// since the world last took them in, so that a tap shorter than a frame
+// still counts.
+struct InputState
 {
-public:
-	static constexpr int DEFAULT_HEIGHT = 16;
-	CollisionBox cb;
-	int no;
-	bool deleteFlag = false;
-	virtual ~IPlatform() = default;
-	virtual void draw() = 0;
-	virtual void process(Uint32 ms) = 0;
+	std::uint8_t held = 0;
+	std::uint8_t pressed = 0;
+	std::uint8_t released = 0;
+
+	void set(InputButton button, bool down)
+	{
+		if (down == bool(held & button))
+			return;
+		if (down)
+		{
+			held |= button;
+			pressed |= button;
+		}
+		else
+		{
+			held &= ~button;
+			released |= button;
+		}
+	}
 };
 
-class BasicPlatform : public IPlatform
+enum PlatformKind
 {
-public:
-	std::string label = "";
-	explicit BasicPlatform(GameWorld *gw, int no, double y);
-	void draw() override;
-	void process(Uint32 ms) override;
-protected:
-	GameWorld *gw;
+	PK_BASIC,
+	PK_DISAPPEARING,
+	PK_FRIENDLY,
+	PK_EVASIVE,
+	PK_RESTLESS,
+	PK_ELEVATOR,
+	PK_SPRING,
+	PK_MOVING
 };
 
-class DisappearingPlatform : public BasicPlatform
+struct DisappearingState
 {
-public:
 	bool running;
-	explicit DisappearingPlatform(GameWorld *gw, int no, double y, double maxt = 0);
-	void draw() override;
-	void process(Uint32 ms) override;
-private:
-	double t;
-	double maxt;
+	Real t;
+	Real maxt;
 };
 
-class FriendlyPlatform : public BasicPlatform
+struct RestlessState
 {
-public:
-	explicit FriendlyPlatform(GameWorld *gw, int no, double y);
-	void process(Uint32 ms) override;
+	Real t;
+	Real targetx;
+	// draws taken so far from the platform's floor stream
+	std::uint32_t draws;
 };
 
-class EvasivePlatform : public BasicPlatform
+struct ElevatorState
 {
-public:
-	explicit EvasivePlatform(GameWorld *gw, int no, double y);
-	void process(Uint32 ms) override;
+	static constexpr Real MAX_SPEED = 800.0;
+	Real ay;
+	Real vy;
 };
 
-class RestlessPlatform : public BasicPlatform
+struct MovingState
 {
-public:
-	explicit RestlessPlatform(GameWorld *gw, int no, double y);
-	void process(Uint32 ms) override;
-private:
-	double t;
-	double targetx;
+	Real centerx;
+	Real spanx;
+	Real freq;
+	Real period;
+	Real t;
 };
 
-class ElevatorPlatform : public BasicPlatform
+// A platform of any kind. The set of kinds is closed, so behaviour is
+// chosen with a switch on the kind instead of virtual calls, and the
+// per-kind state shares storage in a union. The platform's box lives in
+// GameWorld::boxes under the same slot as the platform itself.
+class Platform
 {
 public:
-	static constexpr double MAX_SPEED = 800.0;
-	explicit ElevatorPlatform(GameWorld *gw, int no, double y);
-	void draw() override;
-	void process(Uint32 ms) override;
+	static constexpr int DEFAULT_HEIGHT = 16;
+	PlatformKind kind;
+	int no;
+	bool deleteFlag;
+	const char *label;
+	union
+	{
+		DisappearingState disappearing;
+		RestlessState restless;
+		ElevatorState elevator;
+		MovingState moving;
+	};
+	Platform() = default;
+	static Platform makeBasic(int no, Real y, CollisionBox &cb, FloorRandom &rnd);
+	static Platform makeDisappearing(int no, Real y, CollisionBox &cb, FloorRandom &rnd, Real maxt = 0);
+	static Platform makeFriendly(int no, Real y, CollisionBox &cb, FloorRandom &rnd);
+	static Platform makeEvasive(int no, Real y, CollisionBox &cb, FloorRandom &rnd);
+	static Platform makeRestless(int no, Real y, CollisionBox &cb, FloorRandom &rnd);
+	static Platform makeElevator(int no, Real y, CollisionBox &cb, FloorRandom &rnd);
+	static Platform makeSpring(int no, Real y, CollisionBox &cb, FloorRandom &rnd);
+	static Platform makeMoving(int no, Real y, CollisionBox &cb, FloorRandom &rnd, Real freq = 0);
+	void process(GameWorld &gw, int slot, Real dt);
+	Real fade() const;
 private:
-	double ay;
-	double vy;
+	explicit Platform(PlatformKind kind, int no, Real y, CollisionBox &cb, FloorRandom &rnd);
+	void processDisappearing(Real dt);
+	void processFriendly(GameWorld &gw, int slot, Real dt);
+	void processEvasive(GameWorld &gw, int slot, Real dt);
+	void processRestless(GameWorld &gw, int slot, Real dt);
+	void processElevator(GameWorld &gw, int slot, Real dt);
+	void processMoving(GameWorld &gw, int slot, Real dt);
 };
 
-class SpringPlatform : public BasicPlatform
-{
-public:
-	explicit SpringPlatform(GameWorld *gw, int no, double y);
-};
-
-class MovingPlatform : public IPlatform
-{
-public:
-	explicit MovingPlatform(GameWorld *gw, int no, double y, double freq = 0);
-	void draw() override;
-	void process(Uint32 ms) override;
-private:
-	GameWorld *gw;
-	double centerx;
-	double spanx;
-	double freq;
-	double t;
-};
+// Normally about seven platforms are alive, but a ride on the elevator
+// pins floor 1 at the back of the ring for up to 400 floors.
+using PlatformRing = RingBuffer<Platform, 512>;
 
 class Player
 {
 public:
 	static constexpr int SIZE = 16;
-	static constexpr double DEFAULT_ACCELERATION_X = 2000;
-	static constexpr double DEFAULT_ACCELERATION_Y = 1000;
-	static constexpr double FRICTION = 5;
-	static constexpr double JUMP_POWER = 300;
-	static constexpr double JUMP_COEFFICIENT = 0.002;
+	static constexpr Real DEFAULT_ACCELERATION_X = 2000;
+	static constexpr Real DEFAULT_ACCELERATION_Y = 1000;
+	static constexpr Real FRICTION = 5;
+	static constexpr Real JUMP_POWER = 300;
+	static constexpr Real JUMP_COEFFICIENT = 0.002;
 	CollisionBox cb;
-	double vx;
-	double vy;
-	double ax;
-	double ay;
-	IPlatform *standingPlatform;
+	CollisionBox prevCb;
+	Real vx;
+	Real vy;
+	Real ax;
+	Real ay;
+	Platform *standingPlatform;
 	bool wannaJump;
 	int floorNo;
-	std::list<std::unique_ptr<IPlatform>>::iterator lastCollidedPlatform;
+	int lastCollidedPlatform;
 	Player();
 	void reset();
-	void draw();
 	void jump();
 };
 
+// What a view needs of the world to draw it, copied out after a step so
+// that it can be drawn while the world goes on. The boxes of the step
+// before come along for interpolating.
+struct WorldSnapshot
+{
+	struct Item
+	{
+		// slot of the platform in the ring, stable while it lives
+		int key;
+		Platform platform;
+		CollisionBox box;
+		CollisionBox prevBox;
+	};
+	std::vector<Item> platforms;
+	CollisionBox player;
+	CollisionBox prevPlayer;
+	int floorNo = 0;
+	int hiscore = 0;
+	Real travelledDistance = 0;
+};
+
 class GameWorld
 {
 protected:
-	double travelledDistance = 0.0;
+	Real travelledDistance = 0;
 	int hiscore = 0;
 	int lastSavedHiscore = 0;
+	bool persistent;
+	// every game gets its own tower seed derived from the world's seed,
+	// and every floor is a pure function of the tower seed
+	std::uint64_t seed;
+	std::uint64_t towerSeed;
+	unsigned gamesStarted = 0;
+	// the only platform that moves vertically, kept out of the broadphase
+	int elevatorSlot = PlatformRing::NONE;
+	// first broadphase candidate of the previous step
+	int broadphaseCursor = PlatformRing::NONE;
+	// the direction pressed last wins while both are held
+	bool preferRight = false;
+	void applyInput();
 	void saveHiscore();
 	void loadHiscore();
+	void savePreviousState();
+	void pushPlatform(const Platform &platform, const CollisionBox &cb);
+	void popPlatform();
+	void broadphase(Real top, Real bottom, int &first, int &last);
+	void collideRange(int first, int last, Real oldY);
 public:
 	static constexpr int WALL_WIDTH = 4;
-	static constexpr double BOUNCINESS = 0.7;
-	static constexpr double PLATFORM_DISTANCE = 40;
-	static constexpr double PACE_COEFFICIENT = 0.005;
-	static constexpr Uint32 RESET_TIMEOUT = 2000;
+	static constexpr Real BOUNCINESS = 0.7;
+	static constexpr Real PLATFORM_DISTANCE = 40;
+	static constexpr Real PACE_COEFFICIENT = 0.005;
+	// the view blends biome colours only up to floor 400, and the
+	// distance has to stay in range of a fixed-point Real
+	static constexpr Real MAX_TRAVELLED_DISTANCE = 400 * PLATFORM_DISTANCE;
+	static constexpr std::uint32_t RESET_TIMEOUT = 2000;
+	static constexpr double STEP_MS = 1000.0 / SIM_RATE;
+	static constexpr double MAX_FRAME_MS = 250.0;
 	static constexpr char GAMEDIR[] = ".ictoonmo";
 	static constexpr char HISCORE_FILE[] = "hiscore.dat";
 	Player player;
-	std::list<std::unique_ptr<IPlatform>> platforms;
-	GameWorld();
+	PlatformRing platforms;
+	BoxArrays<PlatformRing::CAPACITY> boxes;
+	// platforms tested against the player in the last step
+	int narrowphaseTests = 0;
+	// steers the player from the next step on; as long as no button
+	// changes, the player's controls can be set directly, as the
+	// autopilot does
+	InputState input;
+	explicit GameWorld(bool persistent = true, std::uint64_t seed = 0);
 	~GameWorld();
-	void draw();
-	void handleEvents();
-	void process(Uint32 ms);
-	bool gameFinished();
+	void process(Real ms);
+	// platform of floor no at height y; depends only on the tower seed
+	// and no, so floors can be generated in any order
+	Platform makeFloor(int no, Real y, CollisionBox &cb) const;
+	bool gameFinished() const;
+	Real getTravelledDistance() const;
+	int getHiscore() const;
+	std::uint64_t getTowerSeed() const;
 	void reset();
 	void printScore();
+	// reuses the storage of out
+	void snapshot(WorldSnapshot &out) const;
 };
 
 #endif
@@ -1,7 +1,11 @@
 #ifndef _H_GFX
 #define _H_GFX
 
-#include <SDL/SDL.h>
+#include "sdl.hpp"
+
+#include <string>
+
+#include "config.hpp"
 
 enum ExceptionCode
 {
@@ -11,27 +15,56 @@ enum ExceptionCode
 	EC_QUIT
 };
 
+// Where finished frames go. Drawing always happens in the screen
+// surface; the backend decides how, or whether, it is shown.
+enum VideoBackend
+{
+	// the SDL 1.2 video surface, or with USE_SDL2 a streaming texture
+	// scaled to the window and presented with vsync
+	VB_SDL,
+	// an off-screen surface whose frames are thrown away, for timing
+	// the game without the cost of presenting
+	VB_NULL
+};
+
 class SDLGuard
 {
 public:
-	SDLGuard();
+	// a single-buffered surface lets GameView present only what changed
+	explicit SDLGuard(bool doubleBuffered = true, VideoBackend backend = VB_SDL);
 	~SDLGuard();
 };
 
-constexpr int SCREEN_WIDTH = 320;
-constexpr int SCREEN_HEIGHT = 240;
-#if defined(_BITTBOY)
-constexpr int SCREEN_BPP = 16;
-constexpr int FPS = 40;
-#elif defined(__EMSCRIPTEN__)
-constexpr int SCREEN_BPP = 32;
-constexpr int FPS = 60;
-#else
-constexpr int SCREEN_BPP = 32;
-constexpr int FPS = 60;
-#endif
+// a software surface of the screen's size in RGB565 or XRGB8888
+SDL_Surface *createFramebuffer(int bpp);
+// whether the screen still holds the last frame when the next one is
+// drawn, so that repainting and presenting what changed is enough
+bool screenRetained();
+void presentScreen();
+void presentScreen(int count, SDL_Rect *rects);
+
+// A string rendered once into a colour-keyed surface in the screen's
+// format and blitted whole from then on. It is rendered again only when
+// the text, font or colour passed to set() changes.
+class TextRun
+{
+public:
+	TextRun() = default;
+	TextRun(const TextRun &) = delete;
+	TextRun &operator=(const TextRun &) = delete;
+	~TextRun();
+	void set(const char *str, int font, Uint32 color);
+	void draw(SDL_Surface *dst, int x, int y) const;
+	int width() const;
+	int height() const;
+private:
+	SDL_Surface *surface = nullptr;
+	std::string text;
+	int font = 0;
+	Uint32 color = 0;
+};
 
-extern unsigned char *psp_font;
+extern const unsigned char *psp_font;
 extern int            psp_font_width;
 extern int            psp_font_height;
 
@@ -44,9 +77,11 @@ extern Uint32 playerColor;
 extern Uint32 playerNegativeColor;
 
 void switchColors();
-bool frameLimiter();
 void psp_change_font(int id);
+// Text is clipped to the clip rectangle of the destination; glyphs
+// entirely inside it take a path without any per-pixel checks.
 void psp_sdl_print(int x, int y, const char *str, Uint32 color);
+void psp_sdl_print(SDL_Surface *dst, int x, int y, const char *str, Uint32 color);
 unsigned char psp_convert_utf8_to_iso_8859_1(unsigned char c1, unsigned char c2);
 
 #endif
@@ -0,0 +1,17 @@
+#ifndef _H_HEADLESS
+#define _H_HEADLESS
+
+#include <random>
+
+#include "game.hpp"
+
+// Steers the player at random every few frames, the same way for the
+// same generator state.
+void autopilot(Player &player, std::mt19937 &rng, unsigned long frame);
+
+// Runs the simulation without a video surface or frame limiter,
+// steering the player with a seeded autopilot, and reports how many
+// simulation steps per second the machine manages.
+void runHeadless(unsigned long frames, unsigned seed);
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef _H_INPUT
+#define _H_INPUT
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "game.hpp"
+#include "spsc.hpp"
+
+typedef std::chrono::steady_clock InputClock;
+
+// One press or release of a game button and when it happened.
+struct InputEdge
+{
+	InputClock::time_point time;
+	InputButton button;
+	bool down;
+};
+
+// Button edges on their way from the thread that reads them to the one
+// that runs the simulation, through a lock-free queue. Each step takes
+// the edges that happened within the span of time it simulates, later
+// ones wait for the next step.
+class InputChannel
+{
+public:
+	static constexpr int QUEUE_SIZE = 64;
+	// producer side; an edge that does not fit any more is dropped
+	void post(const InputEdge &edge);
+	// consumer side: feeds input with the edges that happened up to
+	// until, which is the end of the span of time the next step
+	// simulates
+	void deliver(InputState &input, InputClock::time_point until);
+	// consumer side: prints how long the edges waited from the press to
+	// the step that took them in
+	void printStats(const char *source) const;
+private:
+	SpscQueue<InputEdge, QUEUE_SIZE> queue;
+	std::atomic<unsigned long> dropped{0};
+	unsigned long delivered = 0;
+	InputClock::duration latencyTotal{};
+	InputClock::duration latencyMax{};
+};
+
+// Reads the game buttons straight from the Linux evdev devices on a
+// thread of its own, so that a press is timestamped by the kernel when it
+// happens instead of when the main loop gets round to the SDL queue.
+//
+// Only the buttons that steer the player come this way; SDL still
+// delivers everything else. Without evdev devices, or on builds without
+// threads, start() fails and the buttons come from SDL as before. A
+// device that goes away is dropped; once none is left the thread ends
+// and running() turns false, so that SDL can take over again.
+class InputThread
+{
+public:
+	InputThread() = default;
+	InputThread(const InputThread &) = delete;
+	InputThread &operator=(const InputThread &) = delete;
+	~InputThread();
+	bool start();
+	void stop();
+	bool running() const { return reading; }
+	InputChannel &channel() { return edges; }
+private:
+	struct Device
+	{
+		int fd;
+		// kernel timestamps on the monotonic clock, otherwise the edge
+		// is stamped when it is read
+		bool monotonic;
+	};
+	std::vector<Device> devices;
+	std::thread worker;
+	std::atomic<bool> quit{false};
+	std::atomic<bool> reading{false};
+	InputChannel edges;
+	void run();
+};
+
+#endif
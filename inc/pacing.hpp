@@ -0,0 +1,69 @@
+#ifndef _H_PACING
+#define _H_PACING
+
+#include <chrono>
+
+// Starts frames a fixed period apart. wait() sleeps until the next
+// deadline on the monotonic clock in one go, optionally waking up a
+// little early and spinning for the rest, since a sleep can overshoot by
+// the timer slack of the kernel. A frame that starts late does not make
+// the following ones come sooner; once a whole period has been lost, the
+// deadlines start over from the late frame.
+//
+// With NO_FRAMELIMIT, for devices whose present already waits for the
+// display, wait() returns right away and only notes when the next frame
+// would be due.
+class FramePacer
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+	explicit FramePacer(int fps);
+	// how long before each deadline to stop sleeping and spin instead
+	void setSpin(Clock::duration spin) { this->spin = spin; }
+	void wait();
+	// when the frame after the one wait() last started is due
+	Clock::time_point nextDeadline() const { return deadline; }
+	// prints how late the frames started compared to their deadlines
+	void printStats() const;
+private:
+	Clock::duration period;
+	Clock::duration spin{};
+	Clock::time_point deadline;
+	bool started = false;
+	unsigned long frames = 0;
+	unsigned long missed = 0;
+	double latenessTotal = 0;
+	double latenessSquares = 0;
+	double latenessMax = 0;
+	void sleepUntil(Clock::time_point time);
+};
+
+// Leaves frames undrawn while drawing them would make the next frame
+// late, at most maxSkip in a row, so that a device too slow to draw
+// every frame still simulates in real time and only draws less often.
+// The cost of drawing is estimated from the frames drawn before.
+class FrameSkipper
+{
+public:
+	typedef FramePacer::Clock Clock;
+	explicit FrameSkipper(int maxSkip) : maxSkip{maxSkip} {}
+	// whether to draw the current frame, given when the next one is due
+	bool shouldDraw(Clock::time_point next);
+	// how long drawing and presenting the frame shouldDraw() let
+	// through took; a present that only waits for vsync is left out
+	void drawn(Clock::duration cost);
+	// the share of frames skipped, over the last complete window
+	double skipRatio() const { return ratio; }
+private:
+	static constexpr int WINDOW = 64;
+	int maxSkip;
+	int skippedInRow = 0;
+	// moving average of the cost of drawing
+	Clock::duration estimate{};
+	int windowFrames = 0;
+	int windowSkips = 0;
+	double ratio = 0;
+	void count(bool skipped);
+};
+
+#endif
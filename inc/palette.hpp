@@ -0,0 +1,36 @@
+#ifndef _H_PALETTE
+#define _H_PALETTE
+
+#include "sdl.hpp"
+
+#include "real.hpp"
+
+// Ready-to-write pixel values for the colours GameView computes: the
+// biome background ramp, the fade of disappearing platforms and the
+// elevator. The tables are baked for the screen's pixel format and the
+// current light/dark mode, so a frame only looks colours up.
+class Palette
+{
+public:
+	// background entries over the whole travelled distance ramp
+	static constexpr int RAMP_SIZE = 1024;
+	// steps of a disappearing platform's fade into the background
+	static constexpr int FADE_STEPS = 32;
+	// rebakes the tables when the screen format or the colours changed
+	void update();
+	// also rebakes the fade steps when the background entry changes
+	Uint32 background(Real travelledDistance);
+	Uint32 fade(Real ratio) const;
+	Uint32 elevator() const { return elevatorColor; }
+private:
+	const SDL_PixelFormat *format = nullptr;
+	Uint32 bakedPrimary = 0;
+	int fadeEntry = -1;
+	SDL_Color rampColors[RAMP_SIZE + 1];
+	Uint32 ramp[RAMP_SIZE + 1];
+	Uint32 fadeSteps[FADE_STEPS + 1];
+	Uint32 elevatorColor = 0;
+	void bakeFade(int entry);
+};
+
+#endif
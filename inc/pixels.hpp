@@ -0,0 +1,40 @@
+#ifndef _H_PIXELS
+#define _H_PIXELS
+
+#include "sdl.hpp"
+
+#include <cstdint>
+
+// Pixel writers for one pixel size, instantiated for RGB565 and
+// XRGB8888 and picked at run time from the format of the surface. They
+// step through rows by the surface's pitch, expect the surface to be
+// locked and do no clipping of their own.
+struct PixelKernels
+{
+	int bytesPerPixel;
+	// fills r, which has to lie inside dst
+	void (*fillRect)(SDL_Surface *dst, const SDL_Rect &r, Uint32 color);
+	// plots the set bits of a glyph, one row per entry with pixel 0 in
+	// bit 15; the whole glyph has to lie inside dst
+	void (*putGlyph)(SDL_Surface *dst, int x, int y, Uint32 color,
+		const std::uint16_t *rows, int width, int height);
+	// the same for the columns [cx0, cx1) and rows [cy0, cy1) of the
+	// glyph only, pixel by pixel
+	void (*putGlyphPart)(SDL_Surface *dst, int x, int y, Uint32 color,
+		const std::uint16_t *rows, int cx0, int cx1, int cy0, int cy1);
+};
+
+// nullptr for pixel sizes without kernels
+const PixelKernels *pixelKernels(const SDL_PixelFormat *format);
+
+// bytes stored by fillRect() since the program started, for comparing
+// how much each render path writes
+extern std::uint64_t pixelBytesWritten;
+
+// SDL_FillRect done by the kernels: r (the whole surface if null) is
+// clipped to the clip rectangle of dst, which has to be locked already
+void fillRectLocked(SDL_Surface *dst, const SDL_Rect *r, Uint32 color);
+// the same, locking dst around the fill if it has to be
+void fillRect(SDL_Surface *dst, const SDL_Rect *r, Uint32 color);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef _H_REAL
+#define _H_REAL
+
+// Numeric type of the simulation. Builds for cores without a usable
+// FPU define FIXED_POINT to simulate in Q16.16 fixed point instead of
+// double; the results are then bit-exact on every target.
+#ifdef FIXED_POINT
+#include "fixed.hpp"
+using Real = Fixed;
+#else
+using Real = double;
+
+constexpr int toInt(double v) { return (int)v; }
+constexpr double toDouble(double v) { return v; }
+#endif
+
+constexpr double PI = 3.14159265358979323846;
+
+#endif
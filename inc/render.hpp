@@ -0,0 +1,70 @@
+#ifndef _H_RENDER
+#define _H_RENDER
+
+#include "sdl.hpp"
+
+#include <vector>
+
+#include "gfx.hpp"
+#include "spans.hpp"
+
+enum RenderOp
+{
+	// the colour of everything no fill covers
+	RO_BACKGROUND,
+	RO_FILL,
+	// a TextRun with its top left corner at rect.x, rect.y
+	RO_TEXT
+};
+
+// One step of drawing a frame, small and flat so that a whole frame is a
+// plain array that can be replayed, compared or handed over.
+struct RenderCommand
+{
+	RenderOp op;
+	SDL_Rect rect;
+	Uint32 color;
+	const TextRun *text;
+};
+
+// The commands of one frame, in painting order.
+class RenderBuffer
+{
+public:
+	void clear() { commands.clear(); }
+	void background(Uint32 color);
+	void fill(const SDL_Rect &rect, Uint32 color);
+	void text(const TextRun &run, int x, int y);
+	const std::vector<RenderCommand> &all() const { return commands; }
+private:
+	std::vector<RenderCommand> commands;
+};
+
+enum RenderPath
+{
+	// fills the background and then every rectangle on top of it
+	RP_PAINTER,
+	// writes every pixel once with SpanRenderer
+	RP_SPANS
+};
+
+// Turns a RenderBuffer into pixels along one of the render paths. Text
+// is drawn over all fills, which is where the view records it anyway.
+class Rasterizer
+{
+public:
+	explicit Rasterizer(RenderPath path) : path{path} {}
+	// area, the whole surface if null, has to be the clip rectangle of dst
+	void execute(const RenderBuffer &buffer, SDL_Surface *dst, const SDL_Rect *area);
+private:
+	RenderPath path;
+	SpanRenderer spans;
+};
+
+inline bool overlaps(const SDL_Rect &a, const SDL_Rect &b)
+{
+	return a.x < b.x + b.w && b.x < a.x + a.w &&
+		a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+#endif
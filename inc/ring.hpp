@@ -0,0 +1,95 @@
+#ifndef _H_RING
+#define _H_RING
+
+#include <cstddef>
+
+// Fixed-capacity double-ended ring of in-place items. Items are pushed
+// to the front and popped from the back; the slot an item lives in never
+// changes while it is in the ring, so slot numbers can be kept as handles.
+template <typename T, int N>
+class RingBuffer
+{
+	static_assert(N > 0 && (N & (N - 1)) == 0, "ring capacity must be a power of two");
+public:
+	static constexpr int CAPACITY = N;
+	static constexpr int NONE = -1;
+
+	class iterator
+	{
+	public:
+		iterator(RingBuffer *ring, int pos) : ring{ring}, pos{pos} {}
+		T &operator*() const { return ring->items[ring->slot(pos)]; }
+		T *operator->() const { return &**this; }
+		iterator &operator++() { ++pos; return *this; }
+		bool operator!=(const iterator &other) const { return pos != other.pos; }
+		bool operator==(const iterator &other) const { return pos == other.pos; }
+		int handle() const { return ring->slot(pos); }
+	private:
+		RingBuffer *ring;
+		int pos;
+	};
+
+	class const_iterator
+	{
+	public:
+		const_iterator(const RingBuffer *ring, int pos) : ring{ring}, pos{pos} {}
+		const T &operator*() const { return ring->items[ring->slot(pos)]; }
+		const T *operator->() const { return &**this; }
+		const_iterator &operator++() { ++pos; return *this; }
+		bool operator!=(const const_iterator &other) const { return pos != other.pos; }
+		bool operator==(const const_iterator &other) const { return pos == other.pos; }
+		int handle() const { return ring->slot(pos); }
+	private:
+		const RingBuffer *ring;
+		int pos;
+	};
+
+	int size() const { return count; }
+	bool empty() const { return 0 == count; }
+	bool full() const { return N == count; }
+
+	// slot handle of the item at a given distance from the front
+	int slot(int pos) const { return (head + pos) & (N - 1); }
+	// distance from the front of the item in a given slot; size() or
+	// more when the slot is not in use
+	int position(int handle) const { return (handle - head) & (N - 1); }
+
+	T &operator[](int handle) { return items[handle]; }
+	const T &operator[](int handle) const { return items[handle]; }
+	T &front() { return items[head]; }
+	const T &front() const { return items[head]; }
+	T &back() { return items[slot(count - 1)]; }
+	const T &back() const { return items[slot(count - 1)]; }
+
+	// Makes room at the front and returns the slot handle; the caller
+	// fills items[handle] in place. The ring must not be full.
+	int push_front()
+	{
+		head = (head - 1) & (N - 1);
+		++count;
+		return head;
+	}
+
+	void pop_back()
+	{
+		--count;
+	}
+
+	void clear()
+	{
+		head = 0;
+		count = 0;
+	}
+
+	iterator begin() { return iterator(this, 0); }
+	iterator end() { return iterator(this, count); }
+	const_iterator begin() const { return const_iterator(this, 0); }
+	const_iterator end() const { return const_iterator(this, count); }
+
+private:
+	T items[N];
+	int head = 0;
+	int count = 0;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef _H_RNG
+#define _H_RNG
+
+#include <cstdint>
+
+#include "real.hpp"
+
+// SplitMix64 finalizer: a cheap bijective scramble of all 64 bits.
+inline std::uint64_t mixRandom(std::uint64_t z)
+{
+	z += 0x9e3779b97f4a7c15ull;
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
+
+// Counter-based random numbers for one floor of the tower. Draw k is
+// a hash of (seed, floor, k) and nothing else, so any floor can be
+// generated on its own, in any order, and always comes out the same.
+class FloorRandom
+{
+public:
+	FloorRandom(std::uint64_t seed, int floor, std::uint32_t counter = 0)
+		: key{mixRandom(seed) ^ ((std::uint64_t)(std::uint32_t)floor << 32)}, counter{counter}
+	{
+	}
+
+	std::uint64_t next()
+	{
+		return mixRandom(key ^ counter++);
+	}
+
+	// uniform in [lo, hi]
+	int uniformInt(int lo, int hi)
+	{
+		std::uint64_t range = (std::uint64_t)(hi - lo) + 1;
+		return lo + (int)(((next() >> 32) * range) >> 32);
+	}
+
+	// uniform in [0, 1)
+	Real unitReal()
+	{
+#ifdef FIXED_POINT
+		return Fixed::fromRaw((std::int32_t)(next() >> (64 - Fixed::FRACTION_BITS)));
+#else
+		return (next() >> 11) * 0x1.0p-53;
+#endif
+	}
+
+	// uniform in [lo, hi)
+	Real uniformReal(Real lo, Real hi)
+	{
+		return lo + (hi - lo) * unitReal();
+	}
+
+	std::uint32_t draws() const { return counter; }
+private:
+	std::uint64_t key;
+	std::uint32_t counter;
+};
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef _H_SDL
+#define _H_SDL
+
+// SDL 1.2 by default; desktop builds can define USE_SDL2 to present
+// through an SDL2 streaming texture instead.
+#ifdef USE_SDL2
+#include <SDL2/SDL.h>
+#else
+#include <SDL/SDL.h>
+#endif
+
+#endif
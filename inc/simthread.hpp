@@ -0,0 +1,57 @@
+#ifndef _H_SIMTHREAD
+#define _H_SIMTHREAD
+
+#include <atomic>
+#include <thread>
+
+#include "game.hpp"
+#include "input.hpp"
+#include "triple.hpp"
+
+// One fixed step of the game as it is played: once a game is over, the
+// next one starts after RESET_TIMEOUT.
+void playStep(GameWorld &gw, double &resetTimer);
+
+// Runs the simulation on a thread of its own, in real time, and hands a
+// snapshot of the world after every batch of steps to the thread that
+// draws, through a triple buffer. Neither thread waits for the other, so
+// a slow present does not hold up the simulation and a slow step does
+// not hold up drawing the latest state.
+//
+// While it runs the world belongs to the simulation thread: the view
+// draws the snapshots and posts the steering keys to channel().
+class SimThread
+{
+public:
+	// buttons, if given, are the edges read by an InputThread
+	explicit SimThread(GameWorld &gw, InputChannel *buttons = nullptr);
+	SimThread(const SimThread &) = delete;
+	SimThread &operator=(const SimThread &) = delete;
+	~SimThread();
+	bool start();
+	void stop();
+	bool running() const { return worker.joinable(); }
+	InputChannel &channel() { return keys; }
+	// prints the latency of the keys posted to channel() once stopped
+	bool reportInput = false;
+	// the latest snapshot, valid until the next call, and how far the
+	// clock has gone into the step after it, for interpolating
+	const WorldSnapshot &latest(double &alpha);
+private:
+	struct Published
+	{
+		WorldSnapshot world;
+		// the moment of real time the world had been simulated up to
+		InputClock::time_point time;
+	};
+	GameWorld &gw;
+	InputChannel *buttons;
+	InputChannel keys;
+	TripleBuffer<Published> published;
+	std::thread worker;
+	std::atomic<bool> quit{false};
+	void publish(InputClock::time_point time);
+	void run();
+};
+
+#endif
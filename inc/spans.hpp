@@ -0,0 +1,43 @@
+#ifndef _H_SPANS
+#define _H_SPANS
+
+#include "sdl.hpp"
+
+#include <vector>
+
+// Draws a frame made of filled rectangles so that every pixel of the
+// area is written exactly once. The area is cut into bands of scanlines
+// between rectangle edges; within a band the rectangles are resolved
+// into sorted spans, the topmost one winning where they overlap, and the
+// background only fills the gaps left between them.
+class SpanRenderer
+{
+public:
+	void clear() { layers.clear(); }
+	// rectangles added later cover the ones added before
+	void add(const SDL_Rect &rect, Uint32 color);
+	// dst has to be locked
+	void render(SDL_Surface *dst, const SDL_Rect &area, Uint32 background);
+private:
+	struct Layer
+	{
+		int x0;
+		int y0;
+		int x1;
+		int y1;
+		Uint32 color;
+	};
+	struct Span
+	{
+		int x0;
+		int x1;
+	};
+	std::vector<Layer> layers;
+	std::vector<Layer> visible;
+	std::vector<int> edges;
+	std::vector<Span> covered;
+	void fillUncovered(SDL_Surface *dst, int x0, int x1, int y0, int y1, Uint32 color);
+	void cover(int x0, int x1);
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef _H_SPSC
+#define _H_SPSC
+
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free queue for exactly one producer thread and one
+// consumer thread. Each side owns one of the two indices and only reads
+// the other one, so neither has to wait for the other; a full queue
+// refuses the item instead.
+template <typename T, int N>
+class SpscQueue
+{
+	static_assert(N > 0 && (N & (N - 1)) == 0, "queue capacity must be a power of two");
+public:
+	static constexpr int CAPACITY = N;
+
+	// producer side
+	bool push(const T &item)
+	{
+		unsigned tail = this->tail.load(std::memory_order_relaxed);
+		if (tail - head.load(std::memory_order_acquire) == N)
+			return false;
+		items[tail & (N - 1)] = item;
+		this->tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// consumer side: the oldest item, nullptr when the queue is empty;
+	// it stays valid until pop()
+	const T *peek() const
+	{
+		unsigned head = this->head.load(std::memory_order_relaxed);
+		if (head == tail.load(std::memory_order_acquire))
+			return nullptr;
+		return &items[head & (N - 1)];
+	}
+
+	// consumer side: drops the item peek() returned
+	void pop()
+	{
+		head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+private:
+	T items[N];
+	// both only ever grow and wrap around together; kept on separate
+	// cache lines so that the two threads do not keep stealing one
+	alignas(64) std::atomic<unsigned> head{0};
+	alignas(64) std::atomic<unsigned> tail{0};
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef _H_TRIPLE
+#define _H_TRIPLE
+
+#include <atomic>
+
+// Hands the latest of a stream of values from one writer thread to one
+// reader thread without either ever waiting. The writer fills the back
+// buffer and swaps it with the middle one; the reader swaps the middle
+// one with its front buffer when it is newer. Values the reader never
+// got round to are simply overwritten.
+template <typename T>
+class TripleBuffer
+{
+public:
+	// writer side: the buffer to fill, which still holds whatever it
+	// held two values ago
+	T &back() { return items[backIndex]; }
+	// writer side: makes back() the latest value
+	void publish()
+	{
+		backIndex = middle.exchange(backIndex | FRESH, std::memory_order_acq_rel) & INDEX;
+	}
+
+	// reader side: takes the latest value, if there is a newer one than
+	// front(); false if there is not
+	bool update()
+	{
+		if (!(middle.load(std::memory_order_relaxed) & FRESH))
+			return false;
+		frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & INDEX;
+		return true;
+	}
+	// reader side: stays the same until the next update()
+	const T &front() const { return items[frontIndex]; }
+private:
+	static constexpr unsigned INDEX = 3;
+	static constexpr unsigned FRESH = 4;
+	T items[3];
+	unsigned backIndex = 0;
+	unsigned frontIndex = 1;
+	// index of the middle buffer, with FRESH set while the reader has
+	// not taken it yet
+	std::atomic<unsigned> middle{2};
+};
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef _H_VIEW
+#define _H_VIEW
+
+#include "sdl.hpp"
+
+#include <string>
+#include <vector>
+
+#include "game.hpp"
+#include "gfx.hpp"
+#include "input.hpp"
+#include "palette.hpp"
+#include "render.hpp"
+
+// One filled rectangle of a frame, clipped to the screen, with an
+// optional label on top. key identifies the object it shows from frame
+// to frame.
+struct Sprite
+{
+	int key;
+	SDL_Rect rect;
+	Uint32 color;
+	const char *label;
+	int labelX;
+	int labelY;
+};
+
+// Draws a GameWorld on the global screen and feeds it with SDL input.
+// The world itself knows nothing about SDL.
+//
+// handleEvents() drains the whole event queue once per frame into the
+// world's InputState, which the next simulation step takes in.
+//
+// On a single-buffered surface only the parts of the screen that changed
+// since the previous frame are repainted and presented with
+// presentScreen(); anything that changes the background or wall colour
+// falls back to a full redraw.
+//
+// Text is rendered into TextRuns and only rendered again when the HUD
+// numbers, a label or the colour theme change.
+//
+// A frame is first recorded as a RenderBuffer by prepare(), which does
+// not touch any pixels, and then rasterized and shown by present(). It is
+// drawn from a WorldSnapshot, either taken from the world right then or
+// handed over by a SimThread.
+class GameView
+{
+public:
+	static constexpr int PLAYER_KEY = -1;
+	static constexpr int HUD_FONT = 2;
+	static constexpr int LABEL_FONT = 4;
+	static constexpr int LABEL_RUNS = 4;
+	explicit GameView(GameWorld &gw, RenderPath renderPath = RP_PAINTER);
+	void draw(double alpha = 1.0);
+	void draw(const WorldSnapshot &world, double alpha);
+	void prepare(double alpha);
+	void prepare(const WorldSnapshot &world, double alpha);
+	// rasterize() then show()
+	void present();
+	// draws the recorded frame into the screen surface
+	void rasterize();
+	// presents it, which may wait for the display
+	void show();
+	const RenderBuffer &commands() const { return buffer; }
+	// a line of debug text in the bottom left corner, none if empty
+	void setOverlay(const std::string &text);
+	void handleEvents();
+	// prints how many events were handled and how long the oldest one
+	// of each frame had waited, also when the game is quit if set
+	void printInputStats() const;
+	bool reportInput = false;
+	// whether the arrow and space keys steer the player; off while an
+	// InputThread reads them
+	bool steerFromEvents = true;
+	// when set, the steering keys are posted here, stamped with the time
+	// they were read, instead of set on the world
+	InputChannel *keyChannel = nullptr;
+private:
+	GameWorld &gw;
+	unsigned long inputFrames = 0;
+	unsigned long inputFramesWithEvents = 0;
+	unsigned long inputEvents = 0;
+	unsigned long inputAgeTotal = 0;
+	Uint32 inputAgeMax = 0;
+	Uint32 lastDrain = 0;
+	bool dirtyRects;
+	bool painted = false;
+	bool fullRedraw = true;
+	Uint32 shownPrimary = 0;
+	Palette palette;
+	WorldSnapshot snapshot;
+	std::vector<Sprite> sprites;
+	std::vector<Sprite> shownSprites;
+	std::string hud;
+	int hudFloor = -1;
+	int hudHiscore = -1;
+	bool hudChanged = false;
+	TextRun hudRun;
+	SDL_Rect hudRect;
+	SDL_Rect shownHudRect;
+	std::string overlay;
+	bool overlayChanged = false;
+	TextRun overlayRun;
+	SDL_Rect overlayRect;
+	SDL_Rect shownOverlayRect;
+	std::vector<SDL_Rect> dirty;
+	std::vector<char> shownMatched;
+	RenderBuffer buffer;
+	Rasterizer rasterizer;
+	struct LabelRun
+	{
+		const char *label = nullptr;
+		TextRun run;
+	};
+	LabelRun labelRuns[LABEL_RUNS];
+	int nextLabelRun = 0;
+	TextRun &labelRun(const char *label);
+	void collectSprites(const WorldSnapshot &world, double alpha);
+	Sprite platformSprite(const Platform &p, int key, const CollisionBox &box);
+	void record();
+	void findDirtyRects();
+	void steer(InputButton button, bool down);
+};
+
+#endif
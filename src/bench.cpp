@@ -0,0 +1,107 @@
+#include "bench.hpp"
+#include "game.hpp"
+#include "gfx.hpp"
+#include "headless.hpp"
+#include "pixels.hpp"
+#include "view.hpp"
+
+#include "sdl.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using std::cout;
+using std::endl;
+
+namespace
+{
+	struct FillCase
+	{
+		const char *name;
+		SDL_Rect rect;
+	};
+
+	constexpr FillCase FILL_CASES[] = {
+		{"background", {.x = 0, .y = 0, .w = SCREEN_WIDTH, .h = SCREEN_HEIGHT}},
+		{"wall", {.x = 0, .y = 0, .w = GameWorld::WALL_WIDTH, .h = SCREEN_HEIGHT}},
+		{"floor", {.x = 0, .y = 100, .w = SCREEN_WIDTH, .h = Platform::DEFAULT_HEIGHT}},
+		{"platform", {.x = 37, .y = 100, .w = SCREEN_WIDTH / 4, .h = Platform::DEFAULT_HEIGHT}},
+		{"player", {.x = 151, .y = 100, .w = Player::SIZE, .h = Player::SIZE}},
+	};
+
+	template<typename Fill>
+	double timeFills(SDL_Surface *surface, const SDL_Rect &rect, unsigned long iterations, Fill fill)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (unsigned long i = 0; i < iterations; ++i)
+		{
+			SDL_Rect r = rect;
+			fill(surface, &r, (Uint32)i);
+		}
+		auto stop = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::nano>(stop - start).count() / iterations;
+	}
+}
+
+void runFillBenchmark(unsigned long iterations)
+{
+	if (iterations == 0)
+		return;
+	const int depths[] = {16, 32};
+	for (int bpp : depths)
+	{
+		SDL_Surface *surface = createFramebuffer(bpp);
+		if (!surface)
+			continue;
+		cout << bpp << " bpp, ns per fill (fillRect / SDL_FillRect):" << endl;
+		for (const FillCase &c : FILL_CASES)
+		{
+			double ours = timeFills(surface, c.rect, iterations,
+				[](SDL_Surface *s, SDL_Rect *r, Uint32 color) { fillRect(s, r, color); });
+			double sdl = timeFills(surface, c.rect, iterations,
+				[](SDL_Surface *s, SDL_Rect *r, Uint32 color) { SDL_FillRect(s, r, color); });
+			cout << "  " << c.name << " " << c.rect.w << "x" << c.rect.h << ": "
+				<< ours << " / " << sdl << endl;
+		}
+		SDL_FreeSurface(surface);
+	}
+}
+
+void runRenderBenchmark(unsigned long frames, unsigned seed, bool dirtyRects, VideoBackend backend)
+{
+	if (frames == 0)
+		return;
+	SDLGuard sdl(!dirtyRects, backend);
+	const RenderPath paths[] = {RP_PAINTER, RP_SPANS};
+	const char *names[] = {"painter", "spans"};
+	for (int i = 0; i < 2; ++i)
+	{
+		std::mt19937 rng(seed);
+		GameWorld gw(false, seed);
+		GameView view(gw, paths[i]);
+		std::uint64_t bytes = pixelBytesWritten;
+		unsigned long commands = 0;
+		std::chrono::steady_clock::duration recording{};
+		std::chrono::steady_clock::duration presenting{};
+		for (unsigned long frame = 0; frame < frames; ++frame)
+		{
+			autopilot(gw.player, rng, frame);
+			gw.process(GameWorld::STEP_MS);
+			if (gw.gameFinished())
+				gw.reset();
+			auto start = std::chrono::steady_clock::now();
+			view.prepare(1.0);
+			auto recorded = std::chrono::steady_clock::now();
+			view.present();
+			auto stop = std::chrono::steady_clock::now();
+			recording += recorded - start;
+			presenting += stop - recorded;
+			commands += view.commands().all().size();
+		}
+		cout << names[i] << ": " << (pixelBytesWritten - bytes) / frames << " bytes filled, "
+			<< commands / frames << " commands recorded in "
+			<< std::chrono::duration<double, std::micro>(recording).count() / frames << " us and drawn in "
+			<< std::chrono::duration<double, std::micro>(presenting).count() / frames << " us per frame" << endl;
+	}
+}
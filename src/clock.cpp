@@ -0,0 +1,36 @@
+#include "clock.hpp"
+
+#include <algorithm>
+
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+#define CLOCK_MONOTONIC_NS
+#include <ctime>
+#elif defined(USE_SDL2)
+#include "sdl.hpp"
+#else
+#include <chrono>
+#endif
+
+std::int64_t monotonicNs()
+{
+#if defined(CLOCK_MONOTONIC_NS)
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return std::int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#elif defined(USE_SDL2)
+	static const Uint64 frequency = SDL_GetPerformanceFrequency();
+	Uint64 counter = SDL_GetPerformanceCounter();
+	// in two parts, since the counter times 10^9 would overflow
+	return std::int64_t(counter / frequency) * 1000000000 +
+		std::int64_t(counter % frequency * 1000000000 / frequency);
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void StepClock::advance(std::int64_t now)
+{
+	accumulator = std::min(accumulator + (now - last) * SIM_RATE, MAX_ADVANCE);
+	last = now;
+}
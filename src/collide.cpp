@@ -0,0 +1,81 @@
+#include "collide.hpp"
+
+// the vector paths work on doubles; fixed-point builds target cores
+// without them and only use the scalar loop
+#if !defined(FIXED_POINT) && defined(__AVX__)
+#define COLLIDE_AVX
+#include <immintrin.h>
+#elif !defined(FIXED_POINT) && defined(__SSE2__)
+#define COLLIDE_SSE2
+#include <emmintrin.h>
+#endif
+
+bool CollisionBox::collides(const CollisionBox &cb) const
+{
+	return !((this->x + this->w) < cb.x ||
+		this->x > (cb.x + cb.w) ||
+		(this->y + this->h) < cb.y ||
+		this->y > (cb.y + cb.h));
+}
+
+CollisionBox CollisionBox::interpolate(const CollisionBox &prev, double alpha) const
+{
+	CollisionBox r = *this;
+	Real a = alpha;
+	r.x = prev.x + (x - prev.x) * a;
+	r.y = prev.y + (y - prev.y) * a;
+	return r;
+}
+
+std::uint32_t collideMask(const Real *x, const Real *y, const Real *w, const Real *h,
+	int count, const CollisionBox &box)
+{
+	const Real left = box.x;
+	const Real right = box.x + box.w;
+	const Real top = box.y;
+	const Real bottom = box.y + box.h;
+	std::uint32_t mask = 0;
+	int i = 0;
+
+#if defined(COLLIDE_AVX)
+	const __m256d vleft = _mm256_set1_pd(left);
+	const __m256d vright = _mm256_set1_pd(right);
+	const __m256d vtop = _mm256_set1_pd(top);
+	const __m256d vbottom = _mm256_set1_pd(bottom);
+	for (; i + 4 <= count; i += 4)
+	{
+		__m256d px = _mm256_loadu_pd(x + i);
+		__m256d py = _mm256_loadu_pd(y + i);
+		__m256d pr = _mm256_add_pd(px, _mm256_loadu_pd(w + i));
+		__m256d pb = _mm256_add_pd(py, _mm256_loadu_pd(h + i));
+		__m256d hit = _mm256_and_pd(
+			_mm256_and_pd(_mm256_cmp_pd(px, vright, _CMP_LE_OQ), _mm256_cmp_pd(pr, vleft, _CMP_GE_OQ)),
+			_mm256_and_pd(_mm256_cmp_pd(py, vbottom, _CMP_LE_OQ), _mm256_cmp_pd(pb, vtop, _CMP_GE_OQ)));
+		mask |= (std::uint32_t)_mm256_movemask_pd(hit) << i;
+	}
+#elif defined(COLLIDE_SSE2)
+	const __m128d vleft = _mm_set1_pd(left);
+	const __m128d vright = _mm_set1_pd(right);
+	const __m128d vtop = _mm_set1_pd(top);
+	const __m128d vbottom = _mm_set1_pd(bottom);
+	for (; i + 2 <= count; i += 2)
+	{
+		__m128d px = _mm_loadu_pd(x + i);
+		__m128d py = _mm_loadu_pd(y + i);
+		__m128d pr = _mm_add_pd(px, _mm_loadu_pd(w + i));
+		__m128d pb = _mm_add_pd(py, _mm_loadu_pd(h + i));
+		__m128d hit = _mm_and_pd(
+			_mm_and_pd(_mm_cmple_pd(px, vright), _mm_cmpge_pd(pr, vleft)),
+			_mm_and_pd(_mm_cmple_pd(py, vbottom), _mm_cmpge_pd(pb, vtop)));
+		mask |= (std::uint32_t)_mm_movemask_pd(hit) << i;
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		if (x[i] <= right && x[i] + w[i] >= left &&
+			y[i] <= bottom && y[i] + h[i] >= top)
+			mask |= 1u << i;
+	}
+	return mask;
+}
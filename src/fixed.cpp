@@ -0,0 +1,80 @@
+#include "fixed.hpp"
+#include "real.hpp"
+
+namespace
+{
+	constexpr int SIN_BITS = 10;
+	constexpr int SIN_SIZE = 1 << SIN_BITS;
+	constexpr int SIN_FRACTION_BITS = Fixed::FRACTION_BITS - SIN_BITS;
+
+	// evaluated by the compiler, so the table does not depend on the
+	// target's libm
+	constexpr double taylorSin(double a)
+	{
+		if (a > PI)
+			a -= 2 * PI;
+		double term = a;
+		double sum = a;
+		for (int n = 1; n < 12; ++n)
+		{
+			term *= -a * a / ((2 * n) * (2 * n + 1));
+			sum += term;
+		}
+		return sum;
+	}
+
+	// one full turn, with the first entry repeated at the end so that
+	// interpolation never has to wrap
+	struct SinTable
+	{
+		std::int32_t v[SIN_SIZE + 1];
+
+		constexpr SinTable() : v{}
+		{
+			for (int i = 0; i <= SIN_SIZE; ++i)
+				v[i] = Fixed(taylorSin(2 * PI * i / SIN_SIZE)).raw;
+		}
+	};
+
+	constexpr SinTable sinTable;
+}
+
+Fixed sin(Fixed v)
+{
+	// the fractional part of the angle in turns indexes the table, the
+	// bits below the index interpolate between neighbouring entries
+	constexpr Fixed TURNS_PER_RADIAN = 1 / (2 * PI);
+	std::uint32_t turn = (std::uint32_t)(v * TURNS_PER_RADIAN).raw & (Fixed::ONE - 1);
+	int i = turn >> SIN_FRACTION_BITS;
+	std::int32_t frac = turn & ((1 << SIN_FRACTION_BITS) - 1);
+	std::int32_t a = sinTable.v[i];
+	std::int32_t b = sinTable.v[i + 1];
+	return Fixed::fromRaw(a + (((b - a) * frac) >> SIN_FRACTION_BITS));
+}
+
+Fixed sqrt(Fixed v)
+{
+	if (v.raw <= 0)
+		return 0;
+	// digit-by-digit square root of raw << 16, which is the Q16.16
+	// square root of v
+	std::uint64_t n = (std::uint64_t)v.raw << Fixed::FRACTION_BITS;
+	std::uint64_t root = 0;
+	std::uint64_t bit = (std::uint64_t)1 << 62;
+	while (bit > n)
+		bit >>= 2;
+	while (bit)
+	{
+		if (n >= root + bit)
+		{
+			n -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else
+		{
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return Fixed::fromRaw((std::int32_t)root);
+}
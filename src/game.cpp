@@ -1,12 +1,11 @@
 #include "game.hpp"
-#include "gfx.hpp"
 
-#include <SDL/SDL.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 
 #include <string>
 #include <cmath>
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 
@@ -18,18 +17,13 @@ using std::ofstream;
 using std::endl;
 using std::cout;
 using std::cerr;
-using std::unique_ptr;
-using std::make_unique;
 
 constexpr char GameWorld::GAMEDIR[];
 constexpr char GameWorld::HISCORE_FILE[];
 
-static std::random_device rd;
-static std::mt19937 mt(rd());
-
 void GameWorld::saveHiscore()
 {
-	if (hiscore > lastSavedHiscore)
+	if (persistent && hiscore > lastSavedHiscore)
 	{
 		const char *home = getenv("HOME");
 		string path = string(home) + "/" + GAMEDIR;
@@ -43,6 +37,12 @@ void GameWorld::saveHiscore()
 
 void GameWorld::loadHiscore()
 {
+	if (!persistent)
+	{
+		hiscore = 0;
+		lastSavedHiscore = 0;
+		return;
+	}
 	const char *home = getenv("HOME");
 	string path = string(home) + "/" + GAMEDIR + "/" + HISCORE_FILE;
 	ifstream ifs(path);
@@ -58,7 +58,8 @@ void GameWorld::loadHiscore()
 	}
 }
 
-GameWorld::GameWorld()
+GameWorld::GameWorld(bool persistent, std::uint64_t seed)
+	: persistent{persistent}, seed{seed}
 {
 	loadHiscore();
 	reset();
@@ -66,296 +67,470 @@ GameWorld::GameWorld()
 
 GameWorld::~GameWorld()
 {
-	saveHiscore();
-	printScore();
+	if (persistent)
+	{
+		saveHiscore();
+		printScore();
+	}
 }
 
-void GameWorld::process(Uint32 ms)
+void GameWorld::savePreviousState()
 {
-	if (gameFinished())
-		return;
+	player.prevCb = player.cb;
+	for (auto it = platforms.begin(); it != platforms.end(); ++it)
+		boxes.savePrevious(it.handle());
+}
 
-	double msd = ms / 1000.0;
-	double oldX = player.cb.x;
-	double oldY = player.cb.y;
+void GameWorld::pushPlatform(const Platform &platform, const CollisionBox &cb)
+{
+	// never expected to happen, but if the ring is ever full the oldest
+	// platform is the one to give up
+	if (platforms.full())
+		popPlatform();
+	int slot = platforms.push_front();
+	platforms[slot] = platform;
+	boxes.set(slot, cb);
+}
 
-	player.cb.x += player.vx * msd;
-	if (player.cb.x < WALL_WIDTH)
-	{
-		player.cb.x = WALL_WIDTH;
-		player.vx = -BOUNCINESS * player.vx;
+void GameWorld::popPlatform()
+{
+	if (player.standingPlatform == &platforms.back())
+		player.standingPlatform = nullptr;
+	int slot = platforms.slot(platforms.size() - 1);
+	if (player.lastCollidedPlatform == slot)
+		player.lastCollidedPlatform = PlatformRing::NONE;
+	if (elevatorSlot == slot)
+		elevatorSlot = PlatformRing::NONE;
+	platforms.pop_back();
+}
+
+void GameWorld::broadphase(Real top, Real bottom, int &first, int &last)
+{
+	// Platforms are ordered by height from the front of the ring to the
+	// back, because new floors are pushed to the front. The elevator is
+	// the only platform that moves vertically, so it is left out here
+	// and tested on its own. The walk starts where the previous step's
+	// candidates started, so it is usually over after a step or two.
+	int size = platforms.size();
+	int pos = std::min(platforms.position(broadphaseCursor), size - 1);
+	while (pos > 0)
+	{
+		int prev = pos - 1;
+		while (prev >= 0 && platforms.slot(prev) == elevatorSlot)
+			--prev;
+		if (prev < 0)
+			break;
+		int slot = platforms.slot(prev);
+		if (boxes.y[slot] + boxes.h[slot] < top)
+			break;
+		pos = prev;
 	}
-	if (player.cb.x + player.cb.w > SCREEN_WIDTH - WALL_WIDTH)
+	while (pos < size)
 	{
-		player.cb.x = SCREEN_WIDTH - player.cb.w - WALL_WIDTH;
-		player.vx = -BOUNCINESS * player.vx;
+		int slot = platforms.slot(pos);
+		if (slot != elevatorSlot && boxes.y[slot] + boxes.h[slot] >= top)
+			break;
+		++pos;
 	}
-	player.cb.y += player.vy * msd;
-	player.vx += (player.ax - Player::FRICTION * player.vx) * msd;
-	player.vy += player.ay * msd;
-
-	if (player.vy < 0)
+	first = pos;
+	while (pos < size)
 	{
-		player.lastCollidedPlatform = platforms.end();
+		int slot = platforms.slot(pos);
+		if (slot != elevatorSlot && boxes.y[slot] > bottom)
+			break;
+		++pos;
 	}
+	last = pos;
+	if (first < size)
+		broadphaseCursor = platforms.slot(first);
+}
 
-	for (auto it = platforms.begin(); it != platforms.end(); ++it)
+void GameWorld::collideRange(int first, int last, Real oldY)
+{
+	// test the player against whole batches of platforms at once and
+	// resolve the landing only for the ones that were hit
+	for (int pos = first; pos < last; )
 	{
-		auto &p = *it;
-		if (player.cb.collides(p->cb))
+		int base = platforms.slot(pos);
+		int count = std::min({last - pos, PlatformRing::CAPACITY - base, COLLIDE_BATCH});
+		std::uint32_t hits = boxes.collide(base, count, player.cb);
+		narrowphaseTests += count;
+		for (int k = 0; k < count; ++k)
 		{
+			int handle = base + k;
+			Platform *p = &platforms[handle];
+			if (p->deleteFlag)
+				continue;
+			if (!(hits & (1u << k)))
+			{
+				if (player.lastCollidedPlatform == handle)
+					player.lastCollidedPlatform = PlatformRing::NONE;
+				continue;
+			}
+
+			CollisionBox pcb = boxes.box(handle);
 			// going up or standing
 			if (player.vy < 0 ||
 				(player.standingPlatform &&
-				player.standingPlatform != p.get()))
+				player.standingPlatform != p))
 			{
-				player.lastCollidedPlatform = it;
+				player.lastCollidedPlatform = handle;
 			}
 
 			// going down
-			if (player.vy > 0 && player.lastCollidedPlatform != it)
+			if (player.vy > 0 && player.lastCollidedPlatform != handle)
 			{
 				// if collision is not from side, then proceed
-				double cl = player.cb.x > p->cb.x ? player.cb.x : p->cb.x;
-				double cr = (player.cb.x + player.cb.w) < (p->cb.x + p->cb.w) ?
-							(player.cb.x + player.cb.w) : (p->cb.x + p->cb.w);
-				double cw = cr - cl;
-				double cu = player.cb.y > p->cb.y ? player.cb.y : p->cb.y;
-				double cd = (player.cb.y + player.cb.h) < (p->cb.y + p->cb.h) ?
-							(player.cb.y + player.cb.h) : (p->cb.y + p->cb.h);
-				double ch = cd - cu;
-				if ((cw > ch && (player.cb.y + player.cb.h) < (p->cb.y + p->cb.h)) ||
-					((oldY + player.cb.h) <= p->cb.y))
+				Real cl = player.cb.x > pcb.x ? player.cb.x : pcb.x;
+				Real cr = (player.cb.x + player.cb.w) < (pcb.x + pcb.w) ?
+							(player.cb.x + player.cb.w) : (pcb.x + pcb.w);
+				Real cw = cr - cl;
+				Real cu = player.cb.y > pcb.y ? player.cb.y : pcb.y;
+				Real cd = (player.cb.y + player.cb.h) < (pcb.y + pcb.h) ?
+							(player.cb.y + player.cb.h) : (pcb.y + pcb.h);
+				Real ch = cd - cu;
+				if ((cw > ch && (player.cb.y + player.cb.h) < (pcb.y + pcb.h)) ||
+					((oldY + player.cb.h) <= pcb.y))
 				{
-					player.standingPlatform = p.get();
-					DisappearingPlatform *dp = dynamic_cast<DisappearingPlatform*>(p.get());
-					if (dp)
-						dp->running = true;
+					player.standingPlatform = p;
+					if (PK_DISAPPEARING == p->kind)
+						p->disappearing.running = true;
 					player.vy = 0;
-					player.cb.y = p->cb.y - player.cb.h;
+					player.cb.y = pcb.y - player.cb.h;
 					if (p->no > player.floorNo)
 					{
 						player.floorNo = p->no;
 						if (player.floorNo > hiscore)
 							hiscore = player.floorNo;
 					}
-					SpringPlatform *sp = dynamic_cast<SpringPlatform*>(p.get());
-					if (sp)
+					if (PK_SPRING == p->kind)
 					{
 						player.standingPlatform = nullptr;
 						player.vy = -Player::JUMP_POWER * 2.0;
 					}
+					// the player has moved, so the rest of the batch
+					// has to be tested again
+					hits = boxes.collide(base, count, player.cb);
 				}
 				else
 				{
-					player.lastCollidedPlatform = it;
+					player.lastCollidedPlatform = handle;
 				}
 			}
 		}
-		else
-		{
-			if (player.lastCollidedPlatform == it)
-				player.lastCollidedPlatform = platforms.end();
-		}
-	}
-	if (player.vy > 0)
-	{
-		player.standingPlatform = nullptr;
-	}
-
-	if (player.standingPlatform && player.wannaJump)
-	{
-		player.jump();
+		pos += count;
 	}
+}
 
-	// pacemaker
-	double pace = sqrt((double)((*platforms.rbegin())->no)) * GameWorld::PACE_COEFFICIENT * ms;
-	travelledDistance += pace;
-	player.cb.y += pace;
-	for (auto &p: platforms)
+Platform GameWorld::makeFloor(int no, Real y, CollisionBox &cb) const
+{
+	FloorRandom rnd(towerSeed, no);
+	Platform platform;
+	if (no % 100 == 0)
 	{
-		p->cb.y += pace;
+		platform = Platform::makeBasic(no, y, cb, rnd);
+		cb.w = SCREEN_WIDTH;
+		cb.x = 0;
+		if (100 == no)
+			platform.label = "desert";
+		else if (200 == no)
+			platform.label = "volcano";
+		else if (300 == no)
+			platform.label = "sky";
 	}
-
-	// platform generation
-	if ((*platforms.begin())->cb.y > (GameWorld::PLATFORM_DISTANCE - IPlatform::DEFAULT_HEIGHT))
+	else
 	{
-		int y = (*platforms.begin())->cb.y - PLATFORM_DISTANCE;
-		int no = (*platforms.begin())->no + 1;
-		unique_ptr<IPlatform> platform;
-		if (no % 100 == 0)
+		// meadow
+		if (no < 30)
 		{
-			platform = make_unique<BasicPlatform>(this, no, y);
-			platform->cb.w = SCREEN_WIDTH;
-			platform->cb.x = 0;
-			BasicPlatform *raw = static_cast<BasicPlatform*>(platform.get());
-			if (100 == no)
-				raw->label = "desert";
-			else if (200 == no)
-				raw->label = "volcano";
-			else if (300 == no)
-				raw->label = "sky";
+			platform = Platform::makeFriendly(no, y, cb, rnd);
 		}
-		else
+		else if (no < 100)
 		{
-			// meadow
-			if (no < 30)
+			int chance = rnd.uniformInt(1, 100);
+			if (chance <= 50)
 			{
-				platform = make_unique<FriendlyPlatform>(this, no, y);
+				platform = Platform::makeFriendly(no, y, cb, rnd);
 			}
-			else if (no < 100)
+			else
 			{
-				std::uniform_int_distribution<int> roll(1, 100);
-				int chance = roll(mt);
-				if (chance <= 50)
-				{
-					platform = make_unique<FriendlyPlatform>(this, no, y);
-				}
-				else
-				{
-					platform = make_unique<BasicPlatform>(this, no, y);
-				}
+				platform = Platform::makeBasic(no, y, cb, rnd);
 			}
-			// desert
-			else if (no < 200)
+		}
+		// desert
+		else if (no < 200)
+		{
+			int chance = rnd.uniformInt(1, 100);
+			if (chance <= 20)
 			{
-				std::uniform_int_distribution<int> roll(1, 100);
-				int chance = roll(mt);
-				if (chance <= 20)
-				{
-					platform = make_unique<RestlessPlatform>(this, no, y);
-				}
-				else if (chance <= 70)
-				{
-					platform = make_unique<EvasivePlatform>(this, no, y);
-				}
-				else
-				{
-					platform = make_unique<BasicPlatform>(this, no, y);
-				}
+				platform = Platform::makeRestless(no, y, cb, rnd);
 			}
-			// volcano
-			else if (no < 300)
+			else if (chance <= 70)
 			{
-				std::uniform_int_distribution<int> roll(1, 100);
-				int chance = roll(mt);
-				if (chance <= 50)
-				{
-					platform = make_unique<DisappearingPlatform>(this, no, y);
-				}
-				else
-				{
-					platform = make_unique<BasicPlatform>(this, no, y);
-				}
+				platform = Platform::makeEvasive(no, y, cb, rnd);
+			}
+			else
+			{
+				platform = Platform::makeBasic(no, y, cb, rnd);
 			}
-			// sky
-			else if (no < 400)
+		}
+		// volcano
+		else if (no < 300)
+		{
+			int chance = rnd.uniformInt(1, 100);
+			if (chance <= 50)
 			{
-				std::uniform_int_distribution<int> roll(1, 100);
-				int chance = roll(mt);
-				if (chance <= 30)
-				{
-					platform = make_unique<MovingPlatform>(this, no, y);
-				}
-				else if (chance <= 50)
-				{
-					platform = make_unique<EvasivePlatform>(this, no, y);
-				}
-				else if (chance <= 80)
-				{
-					platform = make_unique<DisappearingPlatform>(this, no, y);
-				}
-				else
-				{
-					platform = make_unique<BasicPlatform>(this, no, y);
-				}
+				platform = Platform::makeDisappearing(no, y, cb, rnd);
 			}
 			else
 			{
-				std::uniform_int_distribution<int> roll(1, 100);
-				int chance = roll(mt);
-				if (chance <= 50)
-				{
-					platform = make_unique<MovingPlatform>(this, no, y);
-				}
-				else
-				{
-					platform = make_unique<BasicPlatform>(this, no, y);
-				}
+				platform = Platform::makeBasic(no, y, cb, rnd);
+			}
+		}
+		// sky
+		else if (no < 400)
+		{
+			int chance = rnd.uniformInt(1, 100);
+			if (chance <= 30)
+			{
+				platform = Platform::makeMoving(no, y, cb, rnd);
+			}
+			else if (chance <= 50)
+			{
+				platform = Platform::makeEvasive(no, y, cb, rnd);
+			}
+			else if (chance <= 80)
+			{
+				platform = Platform::makeDisappearing(no, y, cb, rnd);
+			}
+			else
+			{
+				platform = Platform::makeBasic(no, y, cb, rnd);
 			}
 		}
-		platforms.push_front(std::move(platform));
+		else
+		{
+			int chance = rnd.uniformInt(1, 100);
+			if (chance <= 50)
+			{
+				platform = Platform::makeMoving(no, y, cb, rnd);
+			}
+			else
+			{
+				platform = Platform::makeBasic(no, y, cb, rnd);
+			}
+		}
+	}
+	return platform;
+}
+
+void GameWorld::applyInput()
+{
+	if (!input.pressed && !input.released)
+		return;
+	if (input.pressed & IB_LEFT)
+		preferRight = false;
+	if (input.pressed & IB_RIGHT)
+		preferRight = true;
+	bool left = input.held & IB_LEFT;
+	bool right = input.held & IB_RIGHT;
+	if (left && right)
+		player.ax = preferRight ? Player::DEFAULT_ACCELERATION_X : -Player::DEFAULT_ACCELERATION_X;
+	else if (left)
+		player.ax = -Player::DEFAULT_ACCELERATION_X;
+	else if (right)
+		player.ax = Player::DEFAULT_ACCELERATION_X;
+	else
+		player.ax = 0;
+	player.wannaJump = input.held & IB_JUMP;
+	if ((input.pressed & IB_JUMP) && player.standingPlatform)
+		player.jump();
+	input.pressed = 0;
+	input.released = 0;
+}
+
+void GameWorld::process(Real ms)
+{
+	applyInput();
+	// also when the game is over, so that the view stops interpolating
+	// towards the last state of the game
+	savePreviousState();
+	if (gameFinished())
+		return;
+
+	Real dt = ms / 1000;
+	Real oldY = player.cb.y;
+
+	player.cb.x += player.vx * dt;
+	if (player.cb.x < WALL_WIDTH)
+	{
+		player.cb.x = WALL_WIDTH;
+		player.vx = -BOUNCINESS * player.vx;
+	}
+	if (player.cb.x + player.cb.w > SCREEN_WIDTH - WALL_WIDTH)
+	{
+		player.cb.x = SCREEN_WIDTH - player.cb.w - WALL_WIDTH;
+		player.vx = -BOUNCINESS * player.vx;
+	}
+	player.cb.y += player.vy * dt;
+	player.vx += (player.ax - Player::FRICTION * player.vx) * dt;
+	player.vy += player.ay * dt;
+
+	if (player.vy < 0)
+	{
+		player.lastCollidedPlatform = PlatformRing::NONE;
+	}
+
+	// broadphase: only platforms close to the span swept by the player
+	// this step can touch it
+	Real spanTop = std::min(oldY, player.cb.y) - Platform::DEFAULT_HEIGHT - player.cb.h;
+	Real spanBottom = std::max(oldY, player.cb.y) + player.cb.h;
+	int first, last;
+	broadphase(spanTop, spanBottom, first, last);
+	narrowphaseTests = 0;
+
+	// a platform the player cannot touch cannot stay the last collided one
+	int lastPos = platforms.position(player.lastCollidedPlatform);
+	if (player.lastCollidedPlatform != PlatformRing::NONE &&
+		player.lastCollidedPlatform != elevatorSlot &&
+		(lastPos < first || lastPos >= last))
+	{
+		player.lastCollidedPlatform = PlatformRing::NONE;
+	}
+
+	int elevatorPos = platforms.position(elevatorSlot);
+	bool elevatorApart = elevatorSlot != PlatformRing::NONE &&
+		(elevatorPos < first || elevatorPos >= last);
+	if (elevatorApart && elevatorPos < first)
+		collideRange(elevatorPos, elevatorPos + 1, oldY);
+	collideRange(first, last, oldY);
+	if (elevatorApart && elevatorPos >= last)
+		collideRange(elevatorPos, elevatorPos + 1, oldY);
+
+	if (player.vy > 0)
+	{
+		player.standingPlatform = nullptr;
+	}
+
+	if (player.standingPlatform && player.wannaJump)
+	{
+		player.jump();
+	}
+
+	// pacemaker
+	Real pace = sqrt(Real(platforms.back().no)) * GameWorld::PACE_COEFFICIENT * ms;
+	travelledDistance = std::min(travelledDistance + pace, MAX_TRAVELLED_DISTANCE);
+	player.cb.y += pace;
+	for (auto it = platforms.begin(); it != platforms.end(); ++it)
+	{
+		boxes.y[it.handle()] += pace;
+	}
+
+	// platform generation
+	if (boxes.y[platforms.slot(0)] > (GameWorld::PLATFORM_DISTANCE - Platform::DEFAULT_HEIGHT))
+	{
+		int y = toInt(boxes.y[platforms.slot(0)] - PLATFORM_DISTANCE);
+		int no = platforms.front().no + 1;
+		CollisionBox cb;
+		Platform platform = makeFloor(no, y, cb);
+		pushPlatform(platform, cb);
 	}
 
 	// active platform processing
-	for (auto &p: platforms)
-		p->process(ms);
+	for (auto it = platforms.begin(); it != platforms.end(); ++it)
+		if (!it->deleteFlag)
+			it->process(*this, it.handle(), dt);
 
 	// platform destruction
-	if ((*platforms.rbegin())->cb.y > SCREEN_HEIGHT)
+	if (boxes.y[platforms.slot(platforms.size() - 1)] > SCREEN_HEIGHT)
 	{
-		platforms.pop_back();
+		popPlatform();
 	}
+	// deleted platforms stay in place as tombstones until they reach
+	// the back of the ring, so that no other platform has to move
 	for (auto i = platforms.begin(); i != platforms.end(); ++i)
 	{
-		if ((*i)->deleteFlag)
+		if (i->deleteFlag)
 		{
-			if (player.standingPlatform == (*i).get())
+			if (player.standingPlatform == &*i)
 				player.standingPlatform = nullptr;
-			if (player.lastCollidedPlatform == i)
-				player.lastCollidedPlatform = platforms.end();
-			i = platforms.erase(i);
+			if (player.lastCollidedPlatform == i.handle())
+				player.lastCollidedPlatform = PlatformRing::NONE;
 		}
 	}
+	while (platforms.size() > 1 && platforms.back().deleteFlag)
+	{
+		popPlatform();
+	}
 
 	// perspective adjustment
-	int yDiff = SCREEN_HEIGHT / 6 - player.cb.y;
+	int yDiff = toInt(SCREEN_HEIGHT / 6 - player.cb.y);
 	if (yDiff > 0)
 	{
 		player.cb.y += yDiff;
-		travelledDistance += yDiff;
-		for (auto &p: platforms)
+		travelledDistance = std::min(travelledDistance + yDiff, MAX_TRAVELLED_DISTANCE);
+		for (auto it = platforms.begin(); it != platforms.end(); ++it)
 		{
-			p->cb.y += yDiff;
+			boxes.y[it.handle()] += yDiff;
 		}
 	}
 }
 
-bool GameWorld::gameFinished()
+bool GameWorld::gameFinished() const
 {
 	return player.cb.y > SCREEN_HEIGHT;
 }
 
+Real GameWorld::getTravelledDistance() const
+{
+	return travelledDistance;
+}
+
+int GameWorld::getHiscore() const
+{
+	return hiscore;
+}
+
+std::uint64_t GameWorld::getTowerSeed() const
+{
+	return towerSeed;
+}
+
 void GameWorld::reset()
 {
-	travelledDistance = 0.0;
+	travelledDistance = 0;
 	saveHiscore();
+	towerSeed = mixRandom(seed + mixRandom(gamesStarted++));
 
 	player.reset();
-	platforms.clear();
-	player.lastCollidedPlatform = platforms.end();
-
-	auto base = make_unique<BasicPlatform>(this, 0, SCREEN_HEIGHT - IPlatform::DEFAULT_HEIGHT);
-	base->cb.x = 0;
-	base->cb.w = SCREEN_WIDTH;
-	base->label = "meadow";
-	platforms.push_front(std::move(base));
+	while (!platforms.empty())
+		popPlatform();
+
+	CollisionBox cb;
+	FloorRandom baseRnd(towerSeed, 0);
+	Platform base = Platform::makeBasic(0, SCREEN_HEIGHT - Platform::DEFAULT_HEIGHT, cb, baseRnd);
+	cb.x = 0;
+	cb.w = SCREEN_WIDTH;
+	base.label = "meadow";
+	pushPlatform(base, cb);
 	for (int i = 1; i * PLATFORM_DISTANCE < SCREEN_HEIGHT; ++i)
 	{
+		FloorRandom rnd(towerSeed, i);
 		if (1 == i && hiscore >= 600)
 		{
-			std::uniform_int_distribution<int> roll(1, 100);
-			int chance = roll(mt);
+			int chance = rnd.uniformInt(1, 100);
 			if (chance > 90)
 			{
-				auto platform = make_unique<ElevatorPlatform>(this, i, SCREEN_HEIGHT - IPlatform::DEFAULT_HEIGHT - i * PLATFORM_DISTANCE);
-				platforms.push_front(std::move(platform));
+				Platform platform = Platform::makeElevator(i, SCREEN_HEIGHT - Platform::DEFAULT_HEIGHT - i * PLATFORM_DISTANCE, cb, rnd);
+				pushPlatform(platform, cb);
+				elevatorSlot = platforms.slot(0);
 				continue;
 			}
 		}
-		auto platform = make_unique<FriendlyPlatform>(this, i, SCREEN_HEIGHT - IPlatform::DEFAULT_HEIGHT - i * PLATFORM_DISTANCE);
-		platforms.push_front(std::move(platform));
+		Platform platform = Platform::makeFriendly(i, SCREEN_HEIGHT - Platform::DEFAULT_HEIGHT - i * PLATFORM_DISTANCE, cb, rnd);
+		pushPlatform(platform, cb);
 	}
+	savePreviousState();
 }
 
 void GameWorld::printScore()
@@ -389,388 +564,257 @@ void GameWorld::printScore()
 	cout << "You have reached the " << player.floorNo << postfix << " floor." << endl;
 }
 
-void GameWorld::draw()
+void GameWorld::snapshot(WorldSnapshot &out) const
 {
-	constexpr SDL_Color green = {.r = 144, .g = 255, .b = 144};
-	constexpr SDL_Color yellow = {.r = 255, .g = 255, .b = 144};
-	constexpr SDL_Color red = {.r = 255, .g = 144, .b = 144};
-	constexpr SDL_Color blue = {.r = 144, .g = 144, .b = 255};
-	constexpr SDL_Color gray = {.r = 224, .g = 224, .b = 224};
-	SDL_Color fc = {.r = 0, .g = 0, .b = 0};
-	Uint32 finalColor;
-	if (travelledDistance < PLATFORM_DISTANCE * 100)
-	{
-		double ratio = travelledDistance / (PLATFORM_DISTANCE * 100);
-		fc.r = (1 - ratio) * green.r + ratio * yellow.r;
-		fc.g = (1 - ratio) * green.g + ratio * yellow.g;
-		fc.b = (1 - ratio) * green.b + ratio * yellow.b;
-	}
-	else if (travelledDistance < PLATFORM_DISTANCE * 200)
-	{
-		double ratio = (travelledDistance - PLATFORM_DISTANCE * 100) / (PLATFORM_DISTANCE * 100);
-		fc.r = (1 - ratio) * yellow.r + ratio * red.r;
-		fc.g = (1 - ratio) * yellow.g + ratio * red.g;
-		fc.b = (1 - ratio) * yellow.b + ratio * red.b;
-	}
-	else if (travelledDistance < PLATFORM_DISTANCE * 300)
-	{
-		double ratio = (travelledDistance - PLATFORM_DISTANCE * 200) / (PLATFORM_DISTANCE * 100);
-		fc.r = (1 - ratio) * red.r + ratio * blue.r;
-		fc.g = (1 - ratio) * red.g + ratio * blue.g;
-		fc.b = (1 - ratio) * red.b + ratio * blue.b;
-	}
-	else if (travelledDistance < PLATFORM_DISTANCE * 400)
-	{
-		double ratio = (travelledDistance - PLATFORM_DISTANCE * 300) / (PLATFORM_DISTANCE * 100);
-		fc.r = (1 - ratio) * blue.r + ratio * gray.r;
-		fc.g = (1 - ratio) * blue.g + ratio * gray.g;
-		fc.b = (1 - ratio) * blue.b + ratio * gray.b;
-	}
-	else
-	{
-		fc = gray;
-	}
-	if (darkMode)
+	out.platforms.clear();
+	for (auto it = platforms.begin(); it != platforms.end(); ++it)
+		if (!it->deleteFlag)
+			out.platforms.push_back({it.handle(), *it, boxes.box(it.handle()), boxes.prevBox(it.handle())});
+	out.player = player.cb;
+	out.prevPlayer = player.prevCb;
+	out.floorNo = player.floorNo;
+	out.hiscore = hiscore;
+	out.travelledDistance = travelledDistance;
+}
+
+Platform::Platform(PlatformKind kind, int no, Real y, CollisionBox &cb, FloorRandom &rnd)
+	: kind{kind}, no{no}, deleteFlag{false}, label{nullptr}
+{
+	cb.y = y;
+	cb.h = DEFAULT_HEIGHT;
+	cb.w = rnd.uniformInt(SCREEN_WIDTH / 6, 2 * SCREEN_WIDTH / 6);
+	if (PK_MOVING != kind)
 	{
-		fc.r = 255 - fc.r;
-		fc.g = 255 - fc.g;
-		fc.b = 255 - fc.b;
+		cb.x = rnd.uniformInt(GameWorld::WALL_WIDTH + Player::SIZE / 2, SCREEN_WIDTH - toInt(cb.w) - GameWorld::WALL_WIDTH - Player::SIZE / 2);
 	}
-	finalColor = SDL_MapRGB(screen->format, fc.r, fc.g, fc.b);
-	SDL_FillRect(screen, NULL, finalColor);
-	backgroundColor = finalColor;
-
-	SDL_Rect r = {.x = 0, .y = 0, .w = WALL_WIDTH, .h = SCREEN_HEIGHT};
-	SDL_FillRect(screen, &r, primaryColor);
-	r.x = SCREEN_WIDTH - WALL_WIDTH;
-	SDL_FillRect(screen, &r, primaryColor);
-
-	for (auto &p: platforms)
-		p->draw();
-	player.draw();
-
-	string status = std::to_string(player.floorNo) + "/" + std::to_string(hiscore);
-	int xpos = SCREEN_WIDTH - (status.length() + 1) * 8;
-	int ypos = 4;
-	psp_sdl_print(xpos, ypos, status.c_str(), primaryColor);
-	SDL_Flip(screen);
 }
 
-void GameWorld::handleEvents()
+Platform Platform::makeBasic(int no, Real y, CollisionBox &cb, FloorRandom &rnd)
 {
-	static bool key_left_pressed = false;
-	static bool key_right_pressed = false;
-	SDL_Event event;
+	return Platform(PK_BASIC, no, y, cb, rnd);
+}
 
-	if (SDL_PollEvent(&event))
-		switch (event.type)
-		{
-			case SDL_KEYUP:
-				switch (event.key.keysym.sym)
-				{
-					case SDLK_LEFT:
-						key_left_pressed = false;
-						if (key_right_pressed)
-							player.ax = Player::DEFAULT_ACCELERATION_X;
-						else
-							player.ax = 0;
-						break;
-					case SDLK_RIGHT:
-						key_right_pressed = false;
-						if (key_left_pressed)
-							player.ax = -Player::DEFAULT_ACCELERATION_X;
-						else
-							player.ax = 0;
-						break;
-					case SDLK_SPACE:
-						player.wannaJump = false;
-						break;
-				}
-				break;
-			case SDL_KEYDOWN:
-				switch (event.key.keysym.sym)
-				{
-					case SDLK_RETURN:
-						switchColors();
-						break;
-					case SDLK_SPACE:
-						player.wannaJump = true;
-						if (player.standingPlatform)
-						{
-							player.jump();
-						}
-						break;
-					case SDLK_LEFT:
-						key_left_pressed = true;
-						player.ax = -Player::DEFAULT_ACCELERATION_X;
-						break;
-					case SDLK_RIGHT:
-						key_right_pressed = true;
-						player.ax = Player::DEFAULT_ACCELERATION_X;
-						break;
-					case SDLK_ESCAPE:
-					{
-						SDL_Event ev;
-						ev.type = SDL_QUIT;
-						SDL_PushEvent(&ev);
-						break;
-					}
-				}
-				break;
-			case SDL_QUIT:
-				throw EC_QUIT;
-				break;
-		}
+Platform Platform::makeDisappearing(int no, Real y, CollisionBox &cb, FloorRandom &rnd, Real maxt)
+{
+	Platform p(PK_DISAPPEARING, no, y, cb, rnd);
+	p.disappearing.running = false;
+	p.disappearing.t = 0;
+	p.disappearing.maxt = maxt;
+	if (0 == maxt)
+	{
+		p.disappearing.maxt = rnd.uniformReal(0.3, 1.0);
+	}
+	return p;
 }
 
-void CollisionBox::draw()
+Platform Platform::makeFriendly(int no, Real y, CollisionBox &cb, FloorRandom &rnd)
 {
-	SDL_Rect r = {.x = (Sint16)x, .y = (Sint16)y, .w = (Uint16)w, .h = (Uint16)h};
-	SDL_FillRect(screen, &r, primaryColor);
+	return Platform(PK_FRIENDLY, no, y, cb, rnd);
 }
 
-bool CollisionBox::collides(const CollisionBox &cb)
+Platform Platform::makeEvasive(int no, Real y, CollisionBox &cb, FloorRandom &rnd)
 {
-	return !((this->x + this->w) < cb.x ||
-		this->x > (cb.x + cb.w) ||
-		(this->y + this->h) < cb.y ||
-		this->y > (cb.y + cb.h));
+	return Platform(PK_EVASIVE, no, y, cb, rnd);
 }
 
-BasicPlatform::BasicPlatform(GameWorld *gw, int no, double y)
-	: gw{gw}
+Platform Platform::makeRestless(int no, Real y, CollisionBox &cb, FloorRandom &rnd)
 {
-	this->no = no;
-	this->cb.y = y;
-	this->cb.h = IPlatform::DEFAULT_HEIGHT;
-	std::uniform_int_distribution<int> udw(SCREEN_WIDTH / 6, 2 * SCREEN_WIDTH / 6);
-	this->cb.w = udw(mt);
-	std::uniform_int_distribution<int> udx(GameWorld::WALL_WIDTH + Player::SIZE / 2, SCREEN_WIDTH - this->cb.w - GameWorld::WALL_WIDTH - Player::SIZE / 2);
-	this->cb.x = udx(mt);
+	Platform p(PK_RESTLESS, no, y, cb, rnd);
+	p.restless.targetx = cb.x;
+	p.restless.t = rnd.uniformReal(0.5, 2.0);
+	p.restless.draws = rnd.draws();
+	return p;
 }
 
-void BasicPlatform::draw()
+Platform Platform::makeElevator(int no, Real y, CollisionBox &cb, FloorRandom &rnd)
 {
-	cb.draw();
-	if (label != "")
-	{
-		int posx = cb.x + GameWorld::WALL_WIDTH + 2;
-		int posy = cb.y + 2;
-		psp_change_font(4);
-		if (posy > 0 && posy < (SCREEN_HEIGHT - psp_font_height))
-		{
-			psp_sdl_print(posx, posy, label.c_str(), secondaryColor);
-		}
-		psp_change_font(2);
-	}
+	Platform p(PK_ELEVATOR, no, y, cb, rnd);
+	p.elevator.ay = 0;
+	p.elevator.vy = 0;
+	return p;
 }
 
-void BasicPlatform::process(Uint32 ms)
+Platform Platform::makeSpring(int no, Real y, CollisionBox &cb, FloorRandom &rnd)
 {
-	(void)ms;
+	return Platform(PK_SPRING, no, y, cb, rnd);
 }
 
-DisappearingPlatform::DisappearingPlatform(GameWorld *gw, int no, double y, double maxt)
-	: BasicPlatform(gw, no, y), t{0.0}, maxt{maxt}, running{false}
+Platform Platform::makeMoving(int no, Real y, CollisionBox &cb, FloorRandom &rnd, Real freq)
 {
-	if (0 == maxt)
+	Platform p(PK_MOVING, no, y, cb, rnd);
+	p.moving.centerx = SCREEN_WIDTH / 2;
+	p.moving.spanx = SCREEN_WIDTH / 2;
+	p.moving.freq = freq;
+	if (0 == freq)
 	{
-		std::uniform_real_distribution<> udmt(0.3, 1.0);
-		this->maxt = udmt(mt);
+		p.moving.freq = rnd.uniformReal(0.05, 0.2);
 	}
+	p.moving.period = 1 / p.moving.freq;
+	p.moving.t = rnd.uniformReal(0, 2 * PI);
+	cb.x = p.moving.centerx - cb.w / 2;
+	return p;
 }
 
-void DisappearingPlatform::draw()
+Real Platform::fade() const
 {
-	Uint8 br, bg, bb, fr, fg, fb;
-	SDL_GetRGB(backgroundColor, screen->format, &br, &bg, &bb);
-	SDL_GetRGB(primaryColor, screen->format, &fr, &fg, &fb);
-	double ratio = t / maxt;
-	Uint8 r = ratio * br + (1 - ratio) * fr;
-	Uint8 g = ratio * bg + (1 - ratio) * fg;
-	Uint8 b = ratio * bb + (1 - ratio) * fb;
-	Uint32 finalColor = SDL_MapRGB(screen->format, r, g, b);
-
-	SDL_Rect rect = {.x = (Sint16)cb.x, .y = (Sint16)cb.y, .w = (Uint16)cb.w, .h = (Uint16)cb.h};
-	SDL_FillRect(screen, &rect, finalColor);
+	return disappearing.t / disappearing.maxt;
 }
 
-void DisappearingPlatform::process(Uint32 ms)
+inline void Platform::processDisappearing(Real dt)
 {
-	if (running)
+	DisappearingState &s = disappearing;
+	if (s.running)
 	{
-		t += ms / 1000.0;
-		if (t > maxt)
+		s.t += dt;
+		if (s.t > s.maxt)
 		{
 			deleteFlag = true;
 		}
 	}
 }
 
-FriendlyPlatform::FriendlyPlatform(GameWorld *gw, int no, double y)
-	: BasicPlatform(gw, no, y)
-{
-}
-
-void FriendlyPlatform::process(Uint32 ms)
+inline void Platform::processFriendly(GameWorld &gw, int slot, Real dt)
 {
-	if (this == gw->player.standingPlatform)
+	Real &x = gw.boxes.x[slot];
+	Real y = gw.boxes.y[slot];
+	Real w = gw.boxes.w[slot];
+	if (this == gw.player.standingPlatform)
 	{
-		if (gw->player.cb.x < cb.x - Player::SIZE / 2)
+		if (gw.player.cb.x < x - Player::SIZE / 2)
 		{
-			double dx = cb.x - gw->player.cb.x;
-			cb.x -= 5.0 * dx * ms / 1000.0;
+			Real dx = x - gw.player.cb.x;
+			x -= 5 * dx * dt;
 		}
-		else if (gw->player.cb.x + gw->player.cb.w > cb.x + cb.w + Player::SIZE / 2)
+		else if (gw.player.cb.x + gw.player.cb.w > x + w + Player::SIZE / 2)
 		{
-			double dx = (gw->player.cb.x + gw->player.cb.w) - (cb.x + cb.w);
-			cb.x += 5.0 * dx * ms / 1000.0;
+			Real dx = (gw.player.cb.x + gw.player.cb.w) - (x + w);
+			x += 5 * dx * dt;
 		}
 	}
-	if ((cb.y > SCREEN_HEIGHT - (GameWorld::PLATFORM_DISTANCE + IPlatform::DEFAULT_HEIGHT)) &&
-		(cb.y > gw->player.cb.y) &&
-		(gw->player.cb.y > SCREEN_HEIGHT / 2))
+	if ((y > SCREEN_HEIGHT - (GameWorld::PLATFORM_DISTANCE + DEFAULT_HEIGHT)) &&
+		(y > gw.player.cb.y) &&
+		(gw.player.cb.y > SCREEN_HEIGHT / 2))
 	{
-		double center = cb.x + cb.w / 2;
-		double pcenter = gw->player.cb.x + gw->player.cb.w / 2;
-		if (gw->player.vy > 300.0)
+		Real center = x + w / 2;
+		Real pcenter = gw.player.cb.x + gw.player.cb.w / 2;
+		if (gw.player.vy > 300)
 		{
-			cb.x += 10.0 * (pcenter - center) * ms / 1000.0;
+			x += 10 * (pcenter - center) * dt;
 		}
 	}
 }
 
-EvasivePlatform::EvasivePlatform(GameWorld *gw, int no, double y)
-	: BasicPlatform(gw, no, y)
+inline void Platform::processEvasive(GameWorld &gw, int slot, Real dt)
 {
-}
-
-void EvasivePlatform::process(Uint32 ms)
-{
-	if (this == gw->player.standingPlatform)
+	Real &x = gw.boxes.x[slot];
+	Real w = gw.boxes.w[slot];
+	if (this == gw.player.standingPlatform)
 	{
-		if ((gw->player.cb.x < cb.x - Player::SIZE / 4) &&
-			(gw->player.vx <= 0))
+		if ((gw.player.cb.x < x - Player::SIZE / 4) &&
+			(gw.player.vx <= 0))
 		{
-			double dx = cb.x - gw->player.cb.x;
-			cb.x += 20.0 * dx * ms / 1000.0;
+			Real dx = x - gw.player.cb.x;
+			x += 20 * dx * dt;
 		}
-		else if ((gw->player.cb.x + gw->player.cb.w > cb.x + cb.w + Player::SIZE / 4) &&
-				(gw->player.vx >= 0))
+		else if ((gw.player.cb.x + gw.player.cb.w > x + w + Player::SIZE / 4) &&
+				(gw.player.vx >= 0))
 		{
-			double dx = (gw->player.cb.x + gw->player.cb.w) - (cb.x + cb.w);
-			cb.x -= 20.0 * dx * ms / 1000.0;
+			Real dx = (gw.player.cb.x + gw.player.cb.w) - (x + w);
+			x -= 20 * dx * dt;
 		}
 	}
 }
 
-RestlessPlatform::RestlessPlatform(GameWorld *gw, int no, double y)
-	: BasicPlatform(gw, no, y), targetx(cb.x)
-{
-		std::uniform_real_distribution<> dist(0.5, 2.0);
-		t = dist(mt);
-}
-
-void RestlessPlatform::process(Uint32 ms)
+inline void Platform::processRestless(GameWorld &gw, int slot, Real dt)
 {
-	t -= ms / 1000.0;
-	if (t < 0.0)
+	Real &x = gw.boxes.x[slot];
+	Real w = gw.boxes.w[slot];
+	RestlessState &s = restless;
+	s.t -= dt;
+	if (s.t < 0)
 	{
-		std::uniform_real_distribution<> dist(0.5, 2.0);
-		t = dist(mt);
-		std::uniform_real_distribution<> pos(GameWorld::WALL_WIDTH, SCREEN_WIDTH - GameWorld::WALL_WIDTH - cb.w);
-		targetx = pos(mt);
+		FloorRandom rnd(gw.getTowerSeed(), no, s.draws);
+		s.t = rnd.uniformReal(0.5, 2.0);
+		s.targetx = rnd.uniformReal(GameWorld::WALL_WIDTH, SCREEN_WIDTH - GameWorld::WALL_WIDTH - w);
+		s.draws = rnd.draws();
 	}
-	double dx = targetx - cb.x;
-	double delta = 10.0 * dx * ms / 1000.0;
-	cb.x += delta;
-	if (this == gw->player.standingPlatform)
-		gw->player.cb.x += delta;
-}
-
-ElevatorPlatform::ElevatorPlatform(GameWorld *gw, int no, double y)
-	: BasicPlatform(gw, no, y), ay(0), vy(0)
-{
-}
-
-void ElevatorPlatform::draw()
-{
-	Uint32 finalColor;
-	if (darkMode)
-		finalColor = SDL_MapRGB(screen->format, 0, 255, 255);
-	else
-		finalColor = SDL_MapRGB(screen->format, 255, 0, 0);
-
-	SDL_Rect rect = {.x = (Sint16)cb.x, .y = (Sint16)cb.y, .w = (Uint16)cb.w, .h = (Uint16)cb.h};
-	SDL_FillRect(screen, &rect, finalColor);
+	Real dx = s.targetx - x;
+	Real delta = 10 * dx * dt;
+	x += delta;
+	if (this == gw.player.standingPlatform)
+		gw.player.cb.x += delta;
 }
 
-void ElevatorPlatform::process(Uint32 ms)
+inline void Platform::processElevator(GameWorld &gw, int slot, Real dt)
 {
-	if (this == gw->player.standingPlatform)
+	Real &y = gw.boxes.y[slot];
+	ElevatorState &s = elevator;
+	if (this == gw.player.standingPlatform)
 	{
-		ay = -100.0;
+		s.ay = -100;
 	}
 	else
 	{
-		ay = 100.0;
+		s.ay = 100;
 	}
-	vy += ay * ms / 1000.0;
-	if (vy > 0)
-		vy = 0;
-	if (vy < -MAX_SPEED)
-		vy = -MAX_SPEED;
-	double delta = vy * ms / 1000.0;
-	cb.y += delta;
-	if (this == gw->player.standingPlatform)
+	s.vy += s.ay * dt;
+	if (s.vy > 0)
+		s.vy = 0;
+	if (s.vy < -ElevatorState::MAX_SPEED)
+		s.vy = -ElevatorState::MAX_SPEED;
+	Real delta = s.vy * dt;
+	y += delta;
+	if (this == gw.player.standingPlatform)
 	{
-		gw->player.cb.y += delta;
+		gw.player.cb.y += delta;
 	}
-	if (cb.y < -SCREEN_HEIGHT || (*(gw->platforms.begin()))->no > 401)
+	if (y < -SCREEN_HEIGHT || gw.platforms.front().no > 401)
 	{
 		deleteFlag = true;
 	}
 }
 
-SpringPlatform::SpringPlatform(GameWorld *gw, int no, double y)
-	: BasicPlatform(gw, no, y)
+inline void Platform::processMoving(GameWorld &gw, int slot, Real dt)
 {
+	Real &x = gw.boxes.x[slot];
+	Real w = gw.boxes.w[slot];
+	MovingState &s = moving;
+	s.t += dt;
+	if (s.t > s.period)
+		s.t -= s.period;
+	Real newx = s.centerx + (s.spanx / 2) * sin(2 * PI * s.freq * s.t) - w / 2;
+	Real delta = newx - x;
+	x = newx;
+	if (this == gw.player.standingPlatform)
+		gw.player.cb.x += delta;
 }
 
-MovingPlatform::MovingPlatform(GameWorld *gw, int no, double y, double freq)
-	: gw{gw}, centerx{SCREEN_WIDTH / 2}, spanx{SCREEN_WIDTH / 2}, freq{freq}, t{0.0}
+void Platform::process(GameWorld &gw, int slot, Real dt)
 {
-	this->no = no;
-	this->cb.y = y;
-	this->cb.h = IPlatform::DEFAULT_HEIGHT;
-	std::uniform_int_distribution<int> udw(SCREEN_WIDTH / 6, 2 * SCREEN_WIDTH / 6);
-	this->cb.w = udw(mt);
-	if (0 == freq)
+	switch (kind)
 	{
-		std::uniform_real_distribution<> udf(0.05, 0.2);
-		this->freq = udf(mt);
+		case PK_DISAPPEARING:
+			processDisappearing(dt);
+			break;
+		case PK_FRIENDLY:
+			processFriendly(gw, slot, dt);
+			break;
+		case PK_EVASIVE:
+			processEvasive(gw, slot, dt);
+			break;
+		case PK_RESTLESS:
+			processRestless(gw, slot, dt);
+			break;
+		case PK_ELEVATOR:
+			processElevator(gw, slot, dt);
+			break;
+		case PK_MOVING:
+			processMoving(gw, slot, dt);
+			break;
+		case PK_BASIC:
+		case PK_SPRING:
+			break;
 	}
-	const double pi = std::acos(-1);
-	std::uniform_real_distribution<> udt(0, 2 * pi);
-	this->t = udt(mt);
-}
-
-void MovingPlatform::draw()
-{
-	cb.draw();
-}
-
-void MovingPlatform::process(Uint32 ms)
-{
-	const double pi = std::acos(-1);
-	t += ms / 1000.0;
-	if (t > (1 / freq))
-		t -= (1 / freq);
-	double newx = centerx + (spanx / 2) * sin(2*pi*freq*t) - cb.w / 2;
-	double delta = newx - cb.x;
-	cb.x = newx;
-	if (this == gw->player.standingPlatform)
-		gw->player.cb.x += delta;
 }
 
 Player::Player()
@@ -791,16 +835,13 @@ void Player::reset()
 	standingPlatform = nullptr;
 	wannaJump = false;
 	floorNo = 0;
-}
-
-void Player::draw()
-{
-	SDL_Rect r = {.x = (Sint16)cb.x, .y = (Sint16)cb.y, .w = (Uint16)(cb.w), .h = (Uint16)(cb.h)};
-	SDL_FillRect(screen, &r, playerColor);
+	lastCollidedPlatform = PlatformRing::NONE;
+	prevCb = cb;
 }
 
 void Player::jump()
 {
 	standingPlatform = nullptr;
-	vy = -JUMP_POWER - fabs(vx * vx * JUMP_COEFFICIENT);
+	// kept in this order so that it cannot overflow a fixed-point Real
+	vy = -JUMP_POWER - fabs(vx * (vx * JUMP_COEFFICIENT));
 }
@@ -18,10 +18,11 @@
  */
 
 #include "gfx.hpp"
-#ifdef __EMSCRIPTEN__
-#include <emscripten.h>
-#include <emscripten/html5.h>
-#endif
+#include "pixels.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 
 namespace
 {
@@ -35,19 +36,19 @@ namespace
 	typedef unsigned char uchar;
 	typedef struct psp_font_t {
 		char          *name;
-		unsigned char *font;
+		const unsigned char *font;
 		int            width;
 		int            height;
 	} psp_font_t;
 
-	extern unsigned char psp_font_lat1_6x10[];
-	extern unsigned char psp_font_8859_01_8x8[];
-	extern unsigned char psp_font_lat1_8x8[];
-	extern unsigned char psp_font_lat1_8x10[];
-	extern unsigned char psp_font_lat1_8x12[];
-	extern unsigned char psp_font_lat1_8x14[];
-	extern unsigned char psp_font_lat1_8x16[];
-	extern unsigned char psp_font_lat1_16x22[];
+	extern const unsigned char psp_font_lat1_6x10[];
+	extern const unsigned char psp_font_8859_01_8x8[];
+	extern const unsigned char psp_font_lat1_8x8[];
+	extern const unsigned char psp_font_lat1_8x10[];
+	extern const unsigned char psp_font_lat1_8x12[];
+	extern const unsigned char psp_font_lat1_8x14[];
+	extern const unsigned char psp_font_lat1_8x16[];
+	extern const unsigned char psp_font_lat1_16x22[];
 
 	psp_font_t psp_all_fonts[ GFX_MAX_FONT ] = {
 		 { (char*)"6x10" , psp_font_lat1_6x10 ,  6, 10 },
@@ -60,11 +61,51 @@ namespace
 		 { (char*)"16x22", psp_font_lat1_16x22, 16, 22 }
 	};
 
-	void psp_sdl_put_char(int x, int y, Uint32 color, Uint32 bgcolor, uchar c, int drawfg, int drawbg);
-	auto *psp_sdl_get_vram_addr(uint x, uint y);
+	int psp_font_id = 2;
+
+	VideoBackend videoBackend = VB_SDL;
+	bool screenRetainedFlag = false;
+#ifdef USE_SDL2
+	SDL_Window *window = nullptr;
+	SDL_Renderer *renderer = nullptr;
+	SDL_Texture *texture = nullptr;
+
+	void showTexture()
+	{
+		SDL_RenderClear(renderer);
+		SDL_RenderCopy(renderer, texture, NULL, NULL);
+		SDL_RenderPresent(renderer);
+	}
+#endif
+
+	void closeVideo()
+	{
+#ifdef USE_SDL2
+		if (texture)
+			SDL_DestroyTexture(texture);
+		if (renderer)
+			SDL_DestroyRenderer(renderer);
+		if (window)
+			SDL_DestroyWindow(window);
+		texture = nullptr;
+		renderer = nullptr;
+		window = nullptr;
+		if (screen)
+			SDL_FreeSurface(screen);
+#else
+		// the SDL 1.2 video surface belongs to SDL
+		if (screen && videoBackend == VB_NULL)
+			SDL_FreeSurface(screen);
+#endif
+		screen = nullptr;
+		SDL_Quit();
+	}
+
+	void psp_sdl_draw_string(SDL_Surface *dst, int x, int y, const char *str, Uint32 color);
+	const std::uint16_t *psp_glyph_rows(uchar c);
 }
 
-unsigned char *psp_font = psp_font_lat1_8x8;
+const unsigned char *psp_font = psp_font_lat1_8x8;
 int            psp_font_width  = 8;
 int            psp_font_height = 8;
 
@@ -87,17 +128,72 @@ void switchColors()
 	playerNegativeColor = temp;
 }
 
-SDLGuard::SDLGuard()
+SDLGuard::SDLGuard(bool doubleBuffered, VideoBackend backend)
 {
 	if (screen != nullptr)
 		throw EC_SDLEXIST;
-	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_AUDIO) < 0)
+	videoBackend = backend;
+	Uint32 subsystems = SDL_INIT_TIMER;
+	if (backend != VB_NULL)
+		subsystems |= SDL_INIT_VIDEO | SDL_INIT_AUDIO;
+	if (SDL_Init(subsystems) < 0)
 		throw EC_SDLINIT;
-	screen = SDL_SetVideoMode(SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_BPP, SDL_HWSURFACE | SDL_DOUBLEBUF);
-	if (screen == nullptr)
-		throw EC_SDLVIDEO;
-	SDL_WM_SetCaption("ictoonmo", NULL);
-	SDL_ShowCursor(SDL_DISABLE);
+
+	switch (backend)
+	{
+		case VB_SDL:
+		{
+#ifdef USE_SDL2
+			// our framebuffer goes to a streaming texture that the GPU
+			// scales to the window, presented in step with vsync
+			window = SDL_CreateWindow("ictoonmo", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+				SCREEN_WIDTH * 2, SCREEN_HEIGHT * 2, SDL_WINDOW_RESIZABLE);
+			if (window)
+				renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_PRESENTVSYNC);
+			screen = createFramebuffer(SCREEN_BPP);
+			if (renderer && screen)
+			{
+				SDL_RenderSetLogicalSize(renderer, SCREEN_WIDTH, SCREEN_HEIGHT);
+				const SDL_PixelFormat *fmt = screen->format;
+				texture = SDL_CreateTexture(renderer,
+					SDL_MasksToPixelFormatEnum(fmt->BitsPerPixel, fmt->Rmask, fmt->Gmask, fmt->Bmask, fmt->Amask),
+					SDL_TEXTUREACCESS_STREAMING, SCREEN_WIDTH, SCREEN_HEIGHT);
+			}
+			if (!texture)
+			{
+				closeVideo();
+				throw EC_SDLVIDEO;
+			}
+			screenRetainedFlag = !doubleBuffered;
+#else
+			Uint32 flags = doubleBuffered ? SDL_HWSURFACE | SDL_DOUBLEBUF : SDL_SWSURFACE;
+			// take the depth the display runs at, so that presenting a frame
+			// needs no conversion; SCREEN_BPP is forced only when there are no
+			// kernels for that depth
+			screen = SDL_SetVideoMode(SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_BPP, flags | SDL_ANYFORMAT);
+			if (screen != nullptr && !pixelKernels(screen->format))
+				screen = SDL_SetVideoMode(SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_BPP, flags);
+			if (screen == nullptr || !pixelKernels(screen->format))
+			{
+				closeVideo();
+				throw EC_SDLVIDEO;
+			}
+			SDL_WM_SetCaption("ictoonmo", NULL);
+			screenRetainedFlag = !(screen->flags & SDL_DOUBLEBUF);
+#endif
+			SDL_ShowCursor(SDL_DISABLE);
+			break;
+		}
+		case VB_NULL:
+			screen = createFramebuffer(SCREEN_BPP);
+			if (screen == nullptr)
+			{
+				closeVideo();
+				throw EC_SDLVIDEO;
+			}
+			screenRetainedFlag = !doubleBuffered;
+			break;
+	}
 
 	darkMode = false;
 	primaryColor = SDL_MapRGB(screen->format, 0, 0, 0);
@@ -108,36 +204,59 @@ SDLGuard::SDLGuard()
 
 SDLGuard::~SDLGuard()
 {
-	SDL_Quit();
-	screen = nullptr;
+	closeVideo();
 }
 
-bool frameLimiter()
+SDL_Surface *createFramebuffer(int bpp)
 {
-	static Uint32 curTicks;
-	static Uint32 lastTicks;
-	float t;
-
-#ifdef NO_FRAMELIMIT
-	return false;
-#endif
+	if (bpp == 16)
+		return SDL_CreateRGBSurface(SDL_SWSURFACE, SCREEN_WIDTH, SCREEN_HEIGHT, 16, 0xf800, 0x07e0, 0x001f, 0);
+	return SDL_CreateRGBSurface(SDL_SWSURFACE, SCREEN_WIDTH, SCREEN_HEIGHT, 32, 0xff0000, 0x00ff00, 0x0000ff, 0);
+}
 
-	curTicks = SDL_GetTicks();
-	t = curTicks - lastTicks;
+bool screenRetained()
+{
+	return screenRetainedFlag;
+}
 
-	if (t >= 1000.0/FPS)
+void presentScreen()
+{
+	switch (videoBackend)
 	{
-		lastTicks = curTicks;
-		return false;
+		case VB_SDL:
+#ifdef USE_SDL2
+			SDL_UpdateTexture(texture, NULL, screen->pixels, screen->pitch);
+			showTexture();
+#else
+			SDL_Flip(screen);
+#endif
+			break;
+		case VB_NULL:
+			break;
 	}
+}
 
-#ifdef __EMSCRIPTEN__
-	emscripten_sleep(1);
+void presentScreen(int count, SDL_Rect *rects)
+{
+	switch (videoBackend)
+	{
+		case VB_SDL:
+#ifdef USE_SDL2
+			for (int i = 0; i < count; ++i)
+			{
+				const SDL_Rect &r = rects[i];
+				const Uint8 *pixels = (const Uint8 *)screen->pixels +
+					r.y * screen->pitch + r.x * screen->format->BytesPerPixel;
+				SDL_UpdateTexture(texture, &r, pixels, screen->pitch);
+			}
+			showTexture();
 #else
-	SDL_Delay(1);
+			SDL_UpdateRects(screen, count, rects);
 #endif
-
-	return true;
+			break;
+		case VB_NULL:
+			break;
+	}
 }
 
 void psp_change_font(int id)
@@ -145,6 +264,7 @@ void psp_change_font(int id)
 	if (id < 0 || id >= GFX_MAX_FONT)
 		return;
 
+	psp_font_id = id;
 	psp_font = psp_all_fonts[id].font;
 	psp_font_width  = psp_all_fonts[id].width;
 	psp_font_height = psp_all_fonts[id].height;
@@ -152,21 +272,74 @@ void psp_change_font(int id)
 
 void psp_sdl_print(int x, int y, const char *str, Uint32 color)
 {
-	int index;
-	int x0 = x;
+	psp_sdl_print(screen, x, y, str, color);
+}
 
-	if (SDL_MUSTLOCK(screen))
-		SDL_LockSurface(screen);
-	for (index = 0; str[index] != '\0'; index++) {
-		psp_sdl_put_char(x, y, color, 0, str[index], 1, 0);
-		x += psp_font_width;
-		if (x >= (SCREEN_WIDTH - psp_font_width)) {
-			x = x0; y++;
-		}
-		if (y >= (SCREEN_HEIGHT - psp_font_width)) break;
+void psp_sdl_print(SDL_Surface *dst, int x, int y, const char *str, Uint32 color)
+{
+	if (SDL_MUSTLOCK(dst))
+		SDL_LockSurface(dst);
+	psp_sdl_draw_string(dst, x, y, str, color);
+	if (SDL_MUSTLOCK(dst))
+		SDL_UnlockSurface(dst);
+}
+
+TextRun::~TextRun()
+{
+	if (surface)
+		SDL_FreeSurface(surface);
+}
+
+void TextRun::set(const char *str, int font, Uint32 color)
+{
+	if (surface && font == this->font && color == this->color && text == str)
+		return;
+	if (surface)
+		SDL_FreeSurface(surface);
+	surface = nullptr;
+	text = str;
+	this->font = font;
+	this->color = color;
+	if (text.empty())
+		return;
+
+	int oldFont = psp_font_id;
+	psp_change_font(font);
+	const SDL_PixelFormat *fmt = screen->format;
+	surface = SDL_CreateRGBSurface(SDL_SWSURFACE, text.length() * psp_font_width, psp_font_height,
+		fmt->BitsPerPixel, fmt->Rmask, fmt->Gmask, fmt->Bmask, fmt->Amask);
+	if (surface)
+	{
+		// any value other than the text colour does as the key
+		Uint32 key = color ^ 1;
+		fillRect(surface, NULL, key);
+		psp_sdl_print(surface, 0, 0, str, color);
+#ifdef USE_SDL2
+		SDL_SetColorKey(surface, SDL_TRUE, key);
+		SDL_SetSurfaceRLE(surface, 1);
+#else
+		SDL_SetColorKey(surface, SDL_SRCCOLORKEY | SDL_RLEACCEL, key);
+#endif
 	}
-	if (SDL_MUSTLOCK(screen))
-		SDL_UnlockSurface(screen);
+	psp_change_font(oldFont);
+}
+
+void TextRun::draw(SDL_Surface *dst, int x, int y) const
+{
+	if (!surface)
+		return;
+	SDL_Rect r = {.x = (Sint16)x, .y = (Sint16)y, .w = 0, .h = 0};
+	SDL_BlitSurface(surface, NULL, dst, &r);
+}
+
+int TextRun::width() const
+{
+	return surface ? surface->w : 0;
+}
+
+int TextRun::height() const
+{
+	return surface ? surface->h : 0;
 }
 
 unsigned char psp_convert_utf8_to_iso_8859_1(unsigned char c1, unsigned char c2)
@@ -181,71 +354,42 @@ unsigned char psp_convert_utf8_to_iso_8859_1(unsigned char c1, unsigned char c2)
 
 namespace
 {
-	auto *psp_sdl_get_vram_addr(uint x, uint y)
+	// prints one line of text clipped to the clip rectangle of dst, which
+	// has to be locked already
+	void psp_sdl_draw_string(SDL_Surface *dst, int x, int y, const char *str, Uint32 color)
 	{
-		if constexpr (SCREEN_BPP == 32)
-		{
-			uint *vram = (uint *)screen->pixels;
-			return vram + x + (y * SCREEN_WIDTH);
-		}
-		else
-		{
-			ushort *vram = (ushort *)screen->pixels;
-			return vram + x + (y * SCREEN_WIDTH);
-		}
-	}
-
-	void psp_sdl_put_char(int x, int y, Uint32 color, Uint32 bgcolor, uchar c, int drawfg, int drawbg)
-	{
-	  int cx;
-	  int cy;
-	  int b;
-	  int index;
-
-	  auto *vram = psp_sdl_get_vram_addr(x, y);
+		const SDL_Rect &clip = dst->clip_rect;
+		int left = clip.x;
+		int top = clip.y;
+		int right = clip.x + clip.w;
+		int bottom = clip.y + clip.h;
+		const PixelKernels *kernels = pixelKernels(dst->format);
+		// the 16 bpp blitter works on aligned pixel pairs and may touch
+		// one pixel past the glyph, which must still be inside the row
+		int rowPixels = dst->pitch / kernels->bytesPerPixel;
 
-	  if (psp_font_width > 8) {
-		index = ((ushort)c) * psp_font_height * 2;
-		for (cy=0; cy< psp_font_height; cy++) {
-		  b = 1 << (8 - 1);
-		  for (cx=0; cx< 8; cx++) {
-			if (psp_font[index] & b) {
-			  if (drawfg) vram[cx + cy * SCREEN_WIDTH] = color;
-			} else {
-			  if (drawbg) vram[cx + cy * SCREEN_WIDTH] = bgcolor;
+		for (int index = 0; str[index] != '\0'; index++) {
+			const std::uint16_t *rows = psp_glyph_rows(str[index]);
+			int span = kernels->bytesPerPixel == 2 ? ((x + psp_font_width + 1) & ~1) - x : psp_font_width;
+			if (x >= left && x + psp_font_width <= right && x + span <= rowPixels &&
+				y >= top && y + psp_font_height <= bottom)
+			{
+				kernels->putGlyph(dst, x, y, color, rows, psp_font_width, psp_font_height);
 			}
-			b = b >> 1;
-		  }
-		  index++;
-		  b = 1 << (psp_font_width - 9);
-		  for (cx=0; cx< (psp_font_width - 8); cx++) {
-			if (psp_font[index] & b) {
-			  if (drawfg) vram[8 + cx + cy * SCREEN_WIDTH] = color;
-			} else {
-			  if (drawbg) vram[8 + cx + cy * SCREEN_WIDTH] = bgcolor;
+			else if (x < right && x + psp_font_width > left && y < bottom && y + psp_font_height > top)
+			{
+				// only the part inside the clip rectangle
+				kernels->putGlyphPart(dst, x, y, color, rows,
+					std::max(left - x, 0), std::min(right - x, psp_font_width),
+					std::max(top - y, 0), std::min(bottom - y, psp_font_height));
 			}
-			b = b >> 1;
-		  }
-		  index++;
+			else if (x >= right)
+				break;
+			x += psp_font_width;
 		}
-	  } else {
-		index = ((ushort)c) * psp_font_height;
-		for (cy=0; cy< psp_font_height; cy++) {
-		  b = 1 << (psp_font_width - 1);
-		  for (cx=0; cx< psp_font_width; cx++) {
-			if (psp_font[index] & b) {
-			  if (drawfg) vram[cx + cy * SCREEN_WIDTH] = color;
-			} else {
-			  if (drawbg) vram[cx + cy * SCREEN_WIDTH] = bgcolor;
-			}
-			b = b >> 1;
-		  }
-		  index++;
-		}
-	  }
 	}
 
-	unsigned char psp_font_lat1_6x10[] = {
+	constexpr unsigned char psp_font_lat1_6x10[] = {
 	  0x00>>2, 0xA8>>2, 0x00>>2, 0x88>>2, 0x00>>2, 0x88>>2, 0x00>>2, 0xA8>>2, 0x00>>2, 0x00>>2,
 	  0x00>>2, 0x00>>2, 0x20>>2, 0x70>>2, 0xF8>>2, 0x70>>2, 0x20>>2, 0x00>>2, 0x00>>2, 0x00>>2,
 	  0xA8>>2, 0x54>>2, 0xA8>>2, 0x54>>2, 0xA8>>2, 0x54>>2, 0xA8>>2, 0x54>>2, 0xA8>>2, 0x54>>2,
@@ -504,7 +648,7 @@ namespace
 	  0x00>>2, 0x50>>2, 0x00>>2, 0x88>>2, 0x88>>2, 0x98>>2, 0x68>>2, 0x08>>2, 0x88>>2, 0x70>>2,
 	};
 
-	unsigned char psp_font_8859_01_8x8[] = {
+	constexpr unsigned char psp_font_8859_01_8x8[] = {
 	  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 	  0x7e, 0x81, 0xa5, 0x81, 0xbd, 0x99, 0x81, 0x7e,
 	  0x7e, 0xff, 0xdb, 0xff, 0xc3, 0xe7, 0xff, 0x7e,
@@ -763,7 +907,7 @@ namespace
 	  0xc6, 0x00, 0xc6, 0xc6, 0xc6, 0x7e, 0x06, 0xfc,
 	};
 
-	unsigned char psp_font_lat1_8x8[] = {
+	constexpr unsigned char psp_font_lat1_8x8[] = {
 	  0x7e, 0xc3, 0x99, 0xf3, 0xe7, 0xff, 0xe7, 0x7e,
 	  0x00, 0x76, 0xdc, 0x00, 0x76, 0xdc, 0x00, 0x00,
 	  0x76, 0xd8, 0xd8, 0xdc, 0xd8, 0xd8, 0x76, 0x00,
@@ -1028,7 +1172,7 @@ namespace
 	  0xf0, 0x60, 0x78, 0x6c, 0x6c, 0x78, 0x60, 0xf0,
 	  0xcc, 0x00, 0xcc, 0xcc, 0xcc, 0x7c, 0x0c, 0xf8,
 	};
-	unsigned char psp_font_lat1_8x10[] = {
+	constexpr unsigned char psp_font_lat1_8x10[] = {
 	  0x7e, 0xc3, 0x99, 0xf9, 0xf3, 0xe7, 0xff, 0xe7, 0x7e, 0x00,
 	  0x00, 0x00, 0x76, 0xdc, 0x00, 0x76, 0xdc, 0x00, 0x00, 0x00,
 	  0x00, 0x76, 0xd8, 0xd8, 0xdc, 0xd8, 0xd8, 0x76, 0x00, 0x00,
@@ -1293,7 +1437,7 @@ namespace
 	  0x00, 0xf0, 0x60, 0x78, 0x6c, 0x6c, 0x78, 0x60, 0xf0, 0x00,
 	  0xcc, 0xcc, 0x00, 0xcc, 0xcc, 0xcc, 0x7c, 0x0c, 0xf8, 0x00,
 	};
-	unsigned char psp_font_lat1_8x12[] = {
+	constexpr unsigned char psp_font_lat1_8x12[] = {
 	//0x0
 	  0x7e, 0xc3, 0x99, 0x99, 0xf3, 0xe7, 0xe7, 0xff, 0xe7, 0xe7, 0x7e, 0x00,
 	  0x00, 0x00, 0x00, 0x76, 0xdc, 0x00, 0x76, 0xdc, 0x00, 0x00, 0x00, 0x00,
@@ -1559,7 +1703,7 @@ namespace
 	  0x00, 0xf0, 0x60, 0x60, 0x78, 0x6c, 0x6c, 0x6c, 0x78, 0x60, 0x60, 0xf0,
 	  0x00, 0xc6, 0xc6, 0x00, 0xc6, 0xc6, 0xc6, 0xce, 0x76, 0x06, 0xc6, 0x7c,
 	};
-	unsigned char psp_font_lat1_8x14[] = {
+	constexpr unsigned char psp_font_lat1_8x14[] = {
 	//0x0
 	  0x00, 0x7e, 0xc3, 0x99, 0x99, 0xf3, 0xe7, 0xe7, 0xff, 0xe7, 0xe7, 0x7e, 0x00, 0x00,
 	  0x00, 0x00, 0x00, 0x00, 0x76, 0xdc, 0x00, 0x76, 0xdc, 0x00, 0x00, 0x00, 0x00, 0x00,
@@ -1825,7 +1969,7 @@ namespace
 	  0x00, 0x00, 0x00, 0xf0, 0x60, 0x60, 0x78, 0x6c, 0x6c, 0x6c, 0x78, 0x60, 0x60, 0xf0,
 	  0x00, 0x00, 0xc6, 0xc6, 0x00, 0xc6, 0xc6, 0xc6, 0xce, 0x76, 0x06, 0xc6, 0x7c, 0x00,
 	};
-	unsigned char psp_font_lat1_8x16[] = {
+	constexpr unsigned char psp_font_lat1_8x16[] = {
 	//0x0
 	  0x00, 0x00, 0x7e, 0xc3, 0x99, 0x99, 0xf3, 0xe7, 0xe7, 0xff, 0xe7, 0xe7, 0x7e, 0x00, 0x00, 0x00,
 	  0x00, 0x00, 0x00, 0x00, 0x00, 0x76, 0xdc, 0x00, 0x76, 0xdc, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
@@ -2092,7 +2236,7 @@ namespace
 	  0x00, 0x00, 0x00, 0x6c, 0x00, 0xc6, 0xc6, 0xc6, 0xc6, 0xc6, 0xc6, 0x7e, 0x06, 0x0c, 0xf8, 0x00,
 	};
 
-	unsigned char psp_font_lat1_16x22[] = {
+	constexpr unsigned char psp_font_lat1_16x22[] = {
 	  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 	  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 	  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
@@ -3118,4 +3262,50 @@ namespace
 	  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 	  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
+
+	// Every row of every glyph as 16 bits, pixel 0 in the top bit,
+	// expanded from the font bytes by the compiler. Fonts up to 8 pixels
+	// wide keep a row right-aligned in one byte; wider ones have the
+	// first 8 pixels in one byte and the rest right-aligned in the next.
+	template <int W, int H>
+	struct psp_expanded_font
+	{
+		std::uint16_t rows[256 * H];
+
+		constexpr psp_expanded_font(const unsigned char *font) : rows{}
+		{
+			for (int i = 0; i < 256 * H; ++i)
+			{
+				if (W > 8)
+					rows[i] = (font[2 * i] << 8) | (font[2 * i + 1] << (16 - W));
+				else
+					rows[i] = font[i] << (16 - W);
+			}
+		}
+	};
+
+	constexpr psp_expanded_font<6, 10> psp_rows_6x10(psp_font_lat1_6x10);
+	constexpr psp_expanded_font<8, 8> psp_rows_8859_01_8x8(psp_font_8859_01_8x8);
+	constexpr psp_expanded_font<8, 8> psp_rows_8x8(psp_font_lat1_8x8);
+	constexpr psp_expanded_font<8, 10> psp_rows_8x10(psp_font_lat1_8x10);
+	constexpr psp_expanded_font<8, 12> psp_rows_8x12(psp_font_lat1_8x12);
+	constexpr psp_expanded_font<8, 14> psp_rows_8x14(psp_font_lat1_8x14);
+	constexpr psp_expanded_font<8, 16> psp_rows_8x16(psp_font_lat1_8x16);
+	constexpr psp_expanded_font<16, 22> psp_rows_16x22(psp_font_lat1_16x22);
+
+	constexpr const std::uint16_t *psp_all_rows[GFX_MAX_FONT] = {
+		psp_rows_6x10.rows,
+		psp_rows_8859_01_8x8.rows,
+		psp_rows_8x8.rows,
+		psp_rows_8x10.rows,
+		psp_rows_8x12.rows,
+		psp_rows_8x14.rows,
+		psp_rows_8x16.rows,
+		psp_rows_16x22.rows
+	};
+
+	const std::uint16_t *psp_glyph_rows(uchar c)
+	{
+		return psp_all_rows[psp_font_id] + c * psp_font_height;
+	}
 }
@@ -0,0 +1,63 @@
+#include "headless.hpp"
+#include "game.hpp"
+
+#include <chrono>
+#include <random>
+#include <iostream>
+
+using std::cout;
+using std::endl;
+
+namespace
+{
+	constexpr int AUTOPILOT_PERIOD = 30;
+}
+
+void autopilot(Player &player, std::mt19937 &rng, unsigned long frame)
+{
+	if (frame % AUTOPILOT_PERIOD != 0)
+		return;
+	std::uniform_int_distribution<int> dir(-1, 1);
+	player.ax = dir(rng) * Player::DEFAULT_ACCELERATION_X;
+	std::uniform_int_distribution<int> jump(0, 3);
+	player.wannaJump = jump(rng) != 0;
+}
+
+void runHeadless(unsigned long frames, unsigned seed)
+{
+	std::mt19937 rng(seed);
+	GameWorld gw(false, seed);
+
+	unsigned long games = 1;
+	int bestFloor = 0;
+	unsigned long long tests = 0;
+	int maxTests = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned long frame = 0; frame < frames; ++frame)
+	{
+		autopilot(gw.player, rng, frame);
+		gw.process(GameWorld::STEP_MS);
+		tests += gw.narrowphaseTests;
+		if (gw.narrowphaseTests > maxTests)
+			maxTests = gw.narrowphaseTests;
+		if (gw.gameFinished())
+		{
+			if (gw.player.floorNo > bestFloor)
+				bestFloor = gw.player.floorNo;
+			gw.reset();
+			++games;
+		}
+	}
+	auto stop = std::chrono::steady_clock::now();
+	if (gw.player.floorNo > bestFloor)
+		bestFloor = gw.player.floorNo;
+
+	double seconds = std::chrono::duration<double>(stop - start).count();
+	cout << "Simulated " << frames << " frames in " << seconds << " s ("
+		<< (seconds > 0 ? frames / seconds : 0) << " frames/s)." << endl;
+	cout << "Games: " << games << ", best floor: " << bestFloor
+		<< ", seed: " << seed << "." << endl;
+	cout << "Narrowphase tests per frame: "
+		<< (frames > 0 ? double(tests) / frames : 0) << " on average, "
+		<< maxTests << " at most." << endl;
+}
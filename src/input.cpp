@@ -0,0 +1,193 @@
+#include "input.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+#define INPUT_EVDEV
+#include <cstdio>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+// kernel headers older than 4.16 only have the timeval
+#ifndef input_event_sec
+#define input_event_sec time.tv_sec
+#define input_event_usec time.tv_usec
+#endif
+#endif
+
+using std::cout;
+using std::endl;
+
+#ifdef INPUT_EVDEV
+namespace
+{
+	constexpr int MAX_DEVICES = 32;
+	// how long the thread sleeps at most before it checks for stop()
+	constexpr int POLL_TIMEOUT_MS = 100;
+
+	// the keys SDL maps to SDLK_LEFT, SDLK_RIGHT and SDLK_SPACE
+	bool gameButton(int code, InputButton &button)
+	{
+		switch (code)
+		{
+			case KEY_LEFT:
+				button = IB_LEFT;
+				return true;
+			case KEY_RIGHT:
+				button = IB_RIGHT;
+				return true;
+			case KEY_SPACE:
+				button = IB_JUMP;
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	bool hasKey(const unsigned char *bits, int code)
+	{
+		return bits[code / 8] & (1 << (code % 8));
+	}
+}
+#endif
+
+InputThread::~InputThread()
+{
+	stop();
+}
+
+bool InputThread::start()
+{
+#ifdef INPUT_EVDEV
+	if (worker.joinable())
+		return reading;
+	for (int i = 0; i < MAX_DEVICES; ++i)
+	{
+		char path[32];
+		snprintf(path, sizeof(path), "/dev/input/event%d", i);
+		int fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+		if (fd < 0)
+			continue;
+		unsigned char keys[KEY_MAX / 8 + 1] = {};
+		if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys) < 0 ||
+			!(hasKey(keys, KEY_LEFT) || hasKey(keys, KEY_RIGHT) || hasKey(keys, KEY_SPACE)))
+		{
+			close(fd);
+			continue;
+		}
+		int clock = CLOCK_MONOTONIC;
+		bool monotonic = ioctl(fd, EVIOCSCLOCKID, &clock) == 0;
+		devices.push_back({fd, monotonic});
+	}
+	if (devices.empty())
+		return false;
+	quit = false;
+	reading = true;
+	worker = std::thread(&InputThread::run, this);
+	return true;
+#else
+	return false;
+#endif
+}
+
+void InputThread::stop()
+{
+#ifdef INPUT_EVDEV
+	if (worker.joinable())
+	{
+		quit = true;
+		worker.join();
+	}
+	for (const Device &device : devices)
+		close(device.fd);
+	devices.clear();
+#endif
+}
+
+void InputThread::run()
+{
+#ifdef INPUT_EVDEV
+	std::vector<pollfd> fds;
+	for (const Device &device : devices)
+		fds.push_back({device.fd, POLLIN, 0});
+	while (!quit && !fds.empty())
+	{
+		if (poll(fds.data(), fds.size(), POLL_TIMEOUT_MS) <= 0)
+			continue;
+		for (size_t i = 0; i < fds.size(); ++i)
+		{
+			if (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL))
+			{
+				// unplugged or broken; poll() would keep reporting it
+				// straight away, so drop it for good
+				close(fds[i].fd);
+				fds.erase(fds.begin() + i);
+				devices.erase(devices.begin() + i);
+				--i;
+				continue;
+			}
+			if (!(fds[i].revents & POLLIN))
+				continue;
+			input_event events[16];
+			ssize_t n;
+			while ((n = read(fds[i].fd, events, sizeof(events))) > 0)
+			{
+				InputClock::time_point now = InputClock::now();
+				for (size_t j = 0; j < n / sizeof(input_event); ++j)
+				{
+					const input_event &ev = events[j];
+					InputButton button;
+					// value 2 is autorepeat, which the game has no use for
+					if (ev.type != EV_KEY || ev.value > 1 || !gameButton(ev.code, button))
+						continue;
+					InputClock::time_point time = now;
+					if (devices[i].monotonic)
+						time = InputClock::time_point(std::chrono::seconds(ev.input_event_sec) +
+							std::chrono::microseconds(ev.input_event_usec));
+					edges.post({time, button, ev.value == 1});
+				}
+			}
+		}
+	}
+	reading = false;
+#endif
+}
+
+void InputChannel::post(const InputEdge &edge)
+{
+	if (!queue.push(edge))
+		++dropped;
+}
+
+void InputChannel::deliver(InputState &input, InputClock::time_point until)
+{
+	InputClock::time_point now = InputClock::now();
+	while (const InputEdge *edge = queue.peek())
+	{
+		if (edge->time > until)
+			break;
+		input.set(edge->button, edge->down);
+		InputClock::duration latency = now - edge->time;
+		latencyTotal += latency;
+		latencyMax = std::max(latencyMax, latency);
+		++delivered;
+		queue.pop();
+	}
+}
+
+void InputChannel::printStats(const char *source) const
+{
+	using ms = std::chrono::duration<double, std::milli>;
+	cout << delivered << " button edges from " << source;
+	if (delivered)
+		cout << ", simulated " << ms(latencyTotal).count() / delivered
+			<< " ms after the press on average, " << ms(latencyMax).count() << " ms at most";
+	if (dropped)
+		cout << ", " << dropped << " dropped";
+	cout << endl;
+}
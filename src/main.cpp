@@ -1,43 +1,224 @@
 #include <iostream>
 #include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <ctime>
+#include <string>
 
-#include <SDL/SDL.h>
+#include "sdl.hpp"
 
 #include "gfx.hpp"
 #include "game.hpp"
+#include "headless.hpp"
+#include "input.hpp"
+#include "pacing.hpp"
+#include "simthread.hpp"
+#include "bench.hpp"
+#include "clock.hpp"
+#include "view.hpp"
 
 using std::cout;
 using std::cerr;
 using std::endl;
 
+static void usage(const char *name)
+{
+	cerr << "usage: " << name << " [--headless] [--frames N] [--seed S] [--dirty-rects] [--null-video] [--spans] [--bench-fill N] [--bench-render N] [--input-thread] [--input-stats] [--sim-thread] [--spin US] [--pace-stats] [--frame-skip N] [--skip-overlay]" << endl;
+}
+
 int main(int argc, char *argv[])
 {
+	bool headless = false;
+	bool seeded = false;
+	bool dirtyRects = false;
+	bool inputStats = false;
+	bool readInput = false;
+	bool simThread = false;
+	bool paceStats = false;
+	unsigned long spin = 0;
+	int maxSkip = MAX_FRAME_SKIP;
+	bool skipOverlay = false;
+	RenderPath renderPath = RP_PAINTER;
+	VideoBackend backend = VB_SDL;
+	unsigned long frames = 1000000;
+	unsigned long fills = 0;
+	unsigned long renders = 0;
+	unsigned seed = 0;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "--headless"))
+		{
+			headless = true;
+		}
+		else if (!strcmp(argv[i], "--frames") && i + 1 < argc)
+		{
+			frames = strtoul(argv[++i], nullptr, 10);
+		}
+		else if (!strcmp(argv[i], "--dirty-rects"))
+		{
+			dirtyRects = true;
+		}
+		else if (!strcmp(argv[i], "--null-video"))
+		{
+			backend = VB_NULL;
+		}
+		else if (!strcmp(argv[i], "--input-thread"))
+		{
+			readInput = true;
+		}
+		else if (!strcmp(argv[i], "--sim-thread"))
+		{
+			simThread = true;
+		}
+		else if (!strcmp(argv[i], "--spin") && i + 1 < argc)
+		{
+			spin = strtoul(argv[++i], nullptr, 10);
+		}
+		else if (!strcmp(argv[i], "--frame-skip") && i + 1 < argc)
+		{
+			maxSkip = strtoul(argv[++i], nullptr, 10);
+		}
+		else if (!strcmp(argv[i], "--skip-overlay"))
+		{
+			skipOverlay = true;
+		}
+		else if (!strcmp(argv[i], "--pace-stats"))
+		{
+			paceStats = true;
+		}
+		else if (!strcmp(argv[i], "--input-stats"))
+		{
+			inputStats = true;
+		}
+		else if (!strcmp(argv[i], "--spans"))
+		{
+			renderPath = RP_SPANS;
+		}
+		else if (!strcmp(argv[i], "--bench-render") && i + 1 < argc)
+		{
+			renders = strtoul(argv[++i], nullptr, 10);
+		}
+		else if (!strcmp(argv[i], "--bench-fill") && i + 1 < argc)
+		{
+			fills = strtoul(argv[++i], nullptr, 10);
+		}
+		else if (!strcmp(argv[i], "--seed") && i + 1 < argc)
+		{
+			seed = strtoul(argv[++i], nullptr, 10);
+			seeded = true;
+		}
+		else
+		{
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	// nothing would ever end a game that has no window and no events
+	if (backend == VB_NULL && !renders && !fills && !headless)
+	{
+		usage(argv[0]);
+		return 1;
+	}
+
+	if (!seeded)
+		seed = time(nullptr);
+
+	if (fills)
+	{
+		runFillBenchmark(fills);
+		return 0;
+	}
+
+	if (headless)
+	{
+		runHeadless(frames, seed);
+		return 0;
+	}
+
+	InputThread inputThread;
+	bool evdev = false;
+	FramePacer pacer(FPS);
+	pacer.setSpin(std::chrono::microseconds(spin));
 	try
 	{
-		SDLGuard sdl;
-		GameWorld gw;
+		if (renders)
+		{
+			runRenderBenchmark(renders, seed, dirtyRects, backend);
+			return 0;
+		}
+
+		SDLGuard sdl(!dirtyRects, backend);
+		GameWorld gw(true, seed);
+		GameView view(gw, renderPath);
+		view.reportInput = inputStats;
+		if (readInput)
+		{
+			if (!inputThread.start())
+				cerr << "No evdev input devices, reading the buttons from SDL." << endl;
+		}
 
-		Uint32 resetTimer = 0;
-		Uint32 lastTicks = SDL_GetTicks();
+		evdev = inputThread.running();
+		SimThread sim(gw, evdev ? &inputThread.channel() : nullptr);
+		sim.reportInput = inputStats;
+		if (simThread && !sim.start())
+			cerr << "No threads in this build, simulating between frames." << endl;
+		if (sim.running())
+		{
+			view.keyChannel = &sim.channel();
+			while (true)
+			{
+				pacer.wait();
+				// SDL takes the buttons back if the devices go away
+				view.steerFromEvents = !inputThread.running();
+				view.handleEvents();
+				double alpha;
+				const WorldSnapshot &world = sim.latest(alpha);
+				view.draw(world, alpha);
+			}
+		}
+
+		double resetTimer = 0;
+		StepClock clock(monotonicNs());
+		FrameSkipper skipper(maxSkip);
+		double shownRatio = -1;
 		while (true)
 		{
-			if (!frameLimiter())
+			pacer.wait();
+			view.steerFromEvents = !inputThread.running();
+			view.handleEvents();
+			InputClock::time_point frameTime = InputClock::now();
+			clock.advance(monotonicNs());
+			while (clock.stepDue())
+			{
+				clock.step();
+				// the step simulates up to what is still left over
+				// before this frame; presses after that wait for the
+				// next one
+				if (evdev)
+					inputThread.channel().deliver(gw.input, frameTime - std::chrono::nanoseconds(clock.leftoverNs()));
+				playStep(gw, resetTimer);
+			}
+			if (skipOverlay && skipper.skipRatio() != shownRatio)
 			{
-				gw.draw();
+				shownRatio = skipper.skipRatio();
+				view.setOverlay("skipped " + std::to_string(std::lround(shownRatio * 100)) + "%");
 			}
-			gw.handleEvents();
-			Uint32 oldTicks = lastTicks;
-			lastTicks = SDL_GetTicks();
-			gw.process(lastTicks - oldTicks);
-			if (gw.gameFinished())
+			if (skipper.shouldDraw(pacer.nextDeadline()))
 			{
-				resetTimer += lastTicks - oldTicks;
-				if (resetTimer > GameWorld::RESET_TIMEOUT)
-				{
-					resetTimer = 0;
-					gw.printScore();
-					gw.reset();
-				}
+				FramePacer::Clock::time_point start = FramePacer::Clock::now();
+				view.prepare(clock.alpha());
+				view.rasterize();
+#ifdef USE_SDL2
+				// the renderer presents with vsync, so the present only
+				// waits for the display
+				skipper.drawn(FramePacer::Clock::now() - start);
+				view.show();
+#else
+				// SDL_Flip copies the whole software surface to the screen
+				view.show();
+				skipper.drawn(FramePacer::Clock::now() - start);
+#endif
 			}
 		}
 	}
@@ -56,6 +237,10 @@ int main(int argc, char *argv[])
 				break;
 			case EC_QUIT:
 				// cerr << "Application quitting gracefully..." << endl;
+				if (inputStats && evdev)
+					inputThread.channel().printStats("evdev");
+				if (paceStats)
+					pacer.printStats();
 				break;
 			default:
 				cerr << "Unknown error occured." << endl;
@@ -0,0 +1,118 @@
+#include "pacing.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+#elif defined(__linux__)
+#define PACING_NANOSLEEP
+#include <cerrno>
+#include <ctime>
+#else
+#include <thread>
+#endif
+
+using std::cout;
+using std::endl;
+
+FramePacer::FramePacer(int fps)
+	: period{std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps))}
+{
+}
+
+void FramePacer::sleepUntil(Clock::time_point time)
+{
+#if defined(__EMSCRIPTEN__)
+	// the browser only gets the main loop back while it sleeps, so
+	// sleep even if the deadline has passed
+	std::chrono::duration<double, std::milli> left = time - Clock::now();
+	emscripten_sleep(std::max(0L, std::lround(left.count())));
+#elif defined(PACING_NANOSLEEP)
+	// steady_clock is CLOCK_MONOTONIC on Linux, so its time points can
+	// be handed to the kernel as they are
+	std::chrono::nanoseconds ns = time.time_since_epoch();
+	timespec ts;
+	ts.tv_sec = ns.count() / 1000000000;
+	ts.tv_nsec = ns.count() % 1000000000;
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+		;
+#else
+	std::this_thread::sleep_until(time);
+#endif
+}
+
+void FramePacer::wait()
+{
+	Clock::time_point now = Clock::now();
+#ifdef NO_FRAMELIMIT
+	deadline = now + period;
+	return;
+#endif
+	if (!started)
+	{
+		started = true;
+		deadline = now;
+	}
+	if (deadline - now > spin)
+		sleepUntil(deadline - spin);
+	while ((now = Clock::now()) < deadline)
+		;
+
+	double lateness = std::chrono::duration<double, std::micro>(now - deadline).count();
+	++frames;
+	latenessTotal += lateness;
+	latenessSquares += lateness * lateness;
+	latenessMax = std::max(latenessMax, lateness);
+
+	deadline += period;
+	if (deadline <= now)
+	{
+		++missed;
+		deadline = now + period;
+	}
+}
+
+void FramePacer::printStats() const
+{
+	cout << frames << " frames paced";
+	if (frames)
+	{
+		double mean = latenessTotal / frames;
+		double deviation = std::sqrt(std::max(0.0, latenessSquares / frames - mean * mean));
+		cout << ", started " << mean << " us after the deadline on average (standard deviation "
+			<< deviation << " us), " << latenessMax << " us at most, " << missed << " deadlines missed";
+	}
+	cout << endl;
+}
+
+bool FrameSkipper::shouldDraw(Clock::time_point next)
+{
+	if (skippedInRow >= maxSkip || Clock::now() + estimate <= next)
+	{
+		skippedInRow = 0;
+		count(false);
+		return true;
+	}
+	++skippedInRow;
+	count(true);
+	return false;
+}
+
+void FrameSkipper::drawn(Clock::duration cost)
+{
+	estimate += (cost - estimate) / 8;
+}
+
+void FrameSkipper::count(bool skipped)
+{
+	++windowFrames;
+	if (skipped)
+		++windowSkips;
+	if (windowFrames < WINDOW)
+		return;
+	ratio = double(windowSkips) / windowFrames;
+	windowFrames = 0;
+	windowSkips = 0;
+}
@@ -0,0 +1,114 @@
+#include "palette.hpp"
+#include "gfx.hpp"
+#include "game.hpp"
+
+static SDL_Color biomeColor(double travelledDistance)
+{
+	constexpr SDL_Color green = {.r = 144, .g = 255, .b = 144};
+	constexpr SDL_Color yellow = {.r = 255, .g = 255, .b = 144};
+	constexpr SDL_Color red = {.r = 255, .g = 144, .b = 144};
+	constexpr SDL_Color blue = {.r = 144, .g = 144, .b = 255};
+	constexpr SDL_Color gray = {.r = 224, .g = 224, .b = 224};
+	constexpr double PLATFORM_DISTANCE = toDouble(GameWorld::PLATFORM_DISTANCE);
+	SDL_Color fc = {.r = 0, .g = 0, .b = 0};
+	if (travelledDistance < PLATFORM_DISTANCE * 100)
+	{
+		double ratio = travelledDistance / (PLATFORM_DISTANCE * 100);
+		fc.r = (1 - ratio) * green.r + ratio * yellow.r;
+		fc.g = (1 - ratio) * green.g + ratio * yellow.g;
+		fc.b = (1 - ratio) * green.b + ratio * yellow.b;
+	}
+	else if (travelledDistance < PLATFORM_DISTANCE * 200)
+	{
+		double ratio = (travelledDistance - PLATFORM_DISTANCE * 100) / (PLATFORM_DISTANCE * 100);
+		fc.r = (1 - ratio) * yellow.r + ratio * red.r;
+		fc.g = (1 - ratio) * yellow.g + ratio * red.g;
+		fc.b = (1 - ratio) * yellow.b + ratio * red.b;
+	}
+	else if (travelledDistance < PLATFORM_DISTANCE * 300)
+	{
+		double ratio = (travelledDistance - PLATFORM_DISTANCE * 200) / (PLATFORM_DISTANCE * 100);
+		fc.r = (1 - ratio) * red.r + ratio * blue.r;
+		fc.g = (1 - ratio) * red.g + ratio * blue.g;
+		fc.b = (1 - ratio) * red.b + ratio * blue.b;
+	}
+	else if (travelledDistance < PLATFORM_DISTANCE * 400)
+	{
+		double ratio = (travelledDistance - PLATFORM_DISTANCE * 300) / (PLATFORM_DISTANCE * 100);
+		fc.r = (1 - ratio) * blue.r + ratio * gray.r;
+		fc.g = (1 - ratio) * blue.g + ratio * gray.g;
+		fc.b = (1 - ratio) * blue.b + ratio * gray.b;
+	}
+	else
+	{
+		fc = gray;
+	}
+	return fc;
+}
+
+void Palette::update()
+{
+	if (format == screen->format && bakedPrimary == primaryColor)
+		return;
+	format = screen->format;
+	bakedPrimary = primaryColor;
+	fadeEntry = -1;
+
+	const double maxDistance = toDouble(GameWorld::MAX_TRAVELLED_DISTANCE);
+	for (int i = 0; i <= RAMP_SIZE; ++i)
+	{
+		SDL_Color fc = biomeColor(maxDistance * i / RAMP_SIZE);
+		if (darkMode)
+		{
+			fc.r = 255 - fc.r;
+			fc.g = 255 - fc.g;
+			fc.b = 255 - fc.b;
+		}
+		rampColors[i] = fc;
+		ramp[i] = SDL_MapRGB(format, fc.r, fc.g, fc.b);
+	}
+
+	if (darkMode)
+		elevatorColor = SDL_MapRGB(format, 0, 255, 255);
+	else
+		elevatorColor = SDL_MapRGB(format, 255, 0, 0);
+}
+
+void Palette::bakeFade(int entry)
+{
+	Uint8 fr, fg, fb;
+	SDL_GetRGB(bakedPrimary, format, &fr, &fg, &fb);
+	const SDL_Color &bc = rampColors[entry];
+	for (int i = 0; i <= FADE_STEPS; ++i)
+	{
+		double ratio = (double)i / FADE_STEPS;
+		Uint8 r = ratio * bc.r + (1 - ratio) * fr;
+		Uint8 g = ratio * bc.g + (1 - ratio) * fg;
+		Uint8 b = ratio * bc.b + (1 - ratio) * fb;
+		fadeSteps[i] = SDL_MapRGB(format, r, g, b);
+	}
+	fadeEntry = entry;
+}
+
+Uint32 Palette::background(Real travelledDistance)
+{
+	const int maxDistance = toInt(GameWorld::MAX_TRAVELLED_DISTANCE);
+	int entry = toInt(travelledDistance) * RAMP_SIZE / maxDistance;
+	if (entry < 0)
+		entry = 0;
+	else if (entry > RAMP_SIZE)
+		entry = RAMP_SIZE;
+	if (entry != fadeEntry)
+		bakeFade(entry);
+	return ramp[entry];
+}
+
+Uint32 Palette::fade(Real ratio) const
+{
+	int step = toInt(ratio * FADE_STEPS);
+	if (step < 0)
+		step = 0;
+	else if (step > FADE_STEPS)
+		step = FADE_STEPS;
+	return fadeSteps[step];
+}
@@ -0,0 +1,196 @@
+#include "pixels.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__AVX__)
+#define PIXELS_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#define PIXELS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	// the widest store the target has, used for the middle of each row
+#if defined(PIXELS_AVX)
+	constexpr int FILL_ALIGN = 32;
+#elif defined(PIXELS_SSE2)
+	constexpr int FILL_ALIGN = 16;
+#else
+	// a native register, 32 bits on the MIPS and ARM handhelds
+	typedef std::uintptr_t FillWord __attribute__((may_alias));
+	constexpr int FILL_ALIGN = sizeof(FillWord);
+#endif
+
+	template<typename P>
+	void fillRow(P *row, int n, P color)
+	{
+		// single pixels up to the first aligned address; rows that can
+		// never get there are done this way as a whole
+		while (n > 0 && ((std::uintptr_t)row & (FILL_ALIGN - 1)))
+		{
+			*row++ = color;
+			--n;
+		}
+		constexpr int STEP = FILL_ALIGN / sizeof(P);
+		// every pixel of a 16 bpp pair is the same, so the pattern
+		// does not depend on which half starts the row
+		Uint32 pattern = sizeof(P) == 2 ? (Uint32)color * 0x10001u : (Uint32)color;
+#if defined(PIXELS_AVX)
+		__m256i wide = _mm256_set1_epi32(pattern);
+		for (; n >= STEP; n -= STEP, row += STEP)
+			_mm256_store_si256((__m256i *)row, wide);
+#elif defined(PIXELS_SSE2)
+		__m128i wide = _mm_set1_epi32(pattern);
+		for (; n >= STEP; n -= STEP, row += STEP)
+			_mm_store_si128((__m128i *)row, wide);
+#else
+		FillWord wide = pattern;
+		if constexpr (sizeof(FillWord) > 4)
+			wide |= (FillWord)pattern << 16 << 16;
+		for (; n >= STEP; n -= STEP, row += STEP)
+			*(FillWord *)row = wide;
+#endif
+		while (n-- > 0)
+			*row++ = color;
+	}
+
+	template<typename P>
+	P *pixelAddress(SDL_Surface *dst, int x, int y)
+	{
+		return (P *)((Uint8 *)dst->pixels + y * dst->pitch) + x;
+	}
+
+	template<typename P>
+	void fillRect(SDL_Surface *dst, const SDL_Rect &r, Uint32 color)
+	{
+		P *row = pixelAddress<P>(dst, r.x, r.y);
+		for (int y = 0; y < r.h; ++y, row = (P *)((Uint8 *)row + dst->pitch))
+			fillRow(row, r.w, (P)color);
+	}
+
+	template<typename P>
+	void putGlyphPart(SDL_Surface *dst, int x, int y, Uint32 color,
+		const std::uint16_t *rows, int cx0, int cx1, int cy0, int cy1)
+	{
+		std::uint32_t columns = (0xffffu >> cx0) & ~(0xffffu >> cx1);
+		for (int cy = cy0; cy < cy1; ++cy)
+		{
+			std::uint32_t bits = rows[cy] & columns;
+			while (bits)
+			{
+				int cx = __builtin_clz(bits) - 16;
+				*pixelAddress<P>(dst, x + cx, y + cy) = color;
+				bits &= ~(0x8000u >> cx);
+			}
+		}
+	}
+
+	template<typename P>
+	void putGlyph(SDL_Surface *dst, int x, int y, Uint32 color,
+		const std::uint16_t *rows, int width, int height)
+	{
+		if constexpr (sizeof(P) == 4)
+		{
+			// one pixel per word, so only the set ones are visited
+			P *line = pixelAddress<P>(dst, x, y);
+			for (int cy = 0; cy < height; ++cy, line = (P *)((Uint8 *)line + dst->pitch))
+			{
+				std::uint32_t bits = rows[cy];
+				while (bits)
+				{
+					int cx = __builtin_clz(bits) - 16;
+					line[cx] = color;
+					bits &= ~(0x8000u >> cx);
+				}
+			}
+		}
+		else
+		{
+			// two pixels per word, masked by the pair of row bits; the
+			// row starts on an even pixel so that the stores are aligned
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+			constexpr Uint32 PAIR_MASKS[4] = {0x00000000, 0x0000ffff, 0xffff0000, 0xffffffff};
+#else
+			constexpr Uint32 PAIR_MASKS[4] = {0x00000000, 0xffff0000, 0x0000ffff, 0xffffffff};
+#endif
+			if (((std::uintptr_t)dst->pixels | dst->pitch) & 3)
+			{
+				// rows not word aligned
+				putGlyphPart<P>(dst, x, y, color, rows, 0, width, 0, height);
+				return;
+			}
+			int shift = x & 1;
+			Uint32 *line = (Uint32 *)pixelAddress<P>(dst, x - shift, y);
+			Uint32 pair = (color & 0xffff) | (color << 16);
+			int words = (width + shift + 1) / 2;
+			for (int cy = 0; cy < height; ++cy, line = (Uint32 *)((Uint8 *)line + dst->pitch))
+			{
+				std::uint32_t bits = (std::uint32_t)rows[cy] << (16 - shift);
+				for (int w = 0; w < words && bits; ++w, bits <<= 2)
+				{
+					Uint32 mask = PAIR_MASKS[bits >> 30];
+					if (mask)
+						line[w] = (line[w] & ~mask) | (pair & mask);
+				}
+			}
+		}
+	}
+
+	template<typename P>
+	constexpr PixelKernels kernelsFor()
+	{
+		return {sizeof(P), fillRect<P>, putGlyph<P>, putGlyphPart<P>};
+	}
+
+	constexpr PixelKernels RGB565_KERNELS = kernelsFor<Uint16>();
+	constexpr PixelKernels XRGB8888_KERNELS = kernelsFor<Uint32>();
+}
+
+std::uint64_t pixelBytesWritten = 0;
+
+const PixelKernels *pixelKernels(const SDL_PixelFormat *format)
+{
+	switch (format->BytesPerPixel)
+	{
+		case 2:
+			return &RGB565_KERNELS;
+		case 4:
+			return &XRGB8888_KERNELS;
+		default:
+			return nullptr;
+	}
+}
+
+void fillRectLocked(SDL_Surface *dst, const SDL_Rect *r, Uint32 color)
+{
+	const SDL_Rect &clip = dst->clip_rect;
+	int x0 = clip.x;
+	int y0 = clip.y;
+	int x1 = clip.x + clip.w;
+	int y1 = clip.y + clip.h;
+	if (r)
+	{
+		x0 = std::max<int>(x0, r->x);
+		y0 = std::max<int>(y0, r->y);
+		x1 = std::min<int>(x1, r->x + r->w);
+		y1 = std::min<int>(y1, r->y + r->h);
+	}
+	if (x0 >= x1 || y0 >= y1)
+		return;
+	SDL_Rect area = {.x = (Sint16)x0, .y = (Sint16)y0, .w = (Uint16)(x1 - x0), .h = (Uint16)(y1 - y0)};
+
+	pixelKernels(dst->format)->fillRect(dst, area, color);
+	pixelBytesWritten += (std::uint64_t)area.w * area.h * dst->format->BytesPerPixel;
+}
+
+void fillRect(SDL_Surface *dst, const SDL_Rect *r, Uint32 color)
+{
+	if (SDL_MUSTLOCK(dst))
+		SDL_LockSurface(dst);
+	fillRectLocked(dst, r, color);
+	if (SDL_MUSTLOCK(dst))
+		SDL_UnlockSurface(dst);
+}
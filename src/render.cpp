@@ -0,0 +1,61 @@
+#include "render.hpp"
+#include "pixels.hpp"
+
+void RenderBuffer::background(Uint32 color)
+{
+	commands.push_back(RenderCommand{RO_BACKGROUND, {}, color, nullptr});
+}
+
+void RenderBuffer::fill(const SDL_Rect &rect, Uint32 color)
+{
+	commands.push_back(RenderCommand{RO_FILL, rect, color, nullptr});
+}
+
+void RenderBuffer::text(const TextRun &run, int x, int y)
+{
+	SDL_Rect rect = {.x = (Sint16)x, .y = (Sint16)y, .w = (Uint16)run.width(), .h = (Uint16)run.height()};
+	commands.push_back(RenderCommand{RO_TEXT, rect, 0, &run});
+}
+
+void Rasterizer::execute(const RenderBuffer &buffer, SDL_Surface *dst, const SDL_Rect *area)
+{
+	SDL_Rect whole = {.x = 0, .y = 0, .w = (Uint16)dst->w, .h = (Uint16)dst->h};
+	const SDL_Rect &bounds = area ? *area : whole;
+
+	// one lock for all the fills; text runs are blitted, which needs the
+	// surface unlocked again
+	if (SDL_MUSTLOCK(dst))
+		SDL_LockSurface(dst);
+	switch (path)
+	{
+		case RP_SPANS:
+		{
+			Uint32 background = 0;
+			spans.clear();
+			for (const RenderCommand &c : buffer.all())
+			{
+				if (c.op == RO_BACKGROUND)
+					background = c.color;
+				else if (c.op == RO_FILL)
+					spans.add(c.rect, c.color);
+			}
+			spans.render(dst, bounds, background);
+			break;
+		}
+		case RP_PAINTER:
+			for (const RenderCommand &c : buffer.all())
+			{
+				if (c.op == RO_BACKGROUND)
+					fillRectLocked(dst, &bounds, c.color);
+				else if (c.op == RO_FILL && overlaps(bounds, c.rect))
+					fillRectLocked(dst, &c.rect, c.color);
+			}
+			break;
+	}
+	if (SDL_MUSTLOCK(dst))
+		SDL_UnlockSurface(dst);
+
+	for (const RenderCommand &c : buffer.all())
+		if (c.op == RO_TEXT && overlaps(bounds, c.rect))
+			c.text->draw(dst, c.rect.x, c.rect.y);
+}
@@ -0,0 +1,100 @@
+#include "simthread.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#include "clock.hpp"
+
+void playStep(GameWorld &gw, double &resetTimer)
+{
+	gw.process(GameWorld::STEP_MS);
+	if (gw.gameFinished())
+	{
+		resetTimer += GameWorld::STEP_MS;
+		if (resetTimer > GameWorld::RESET_TIMEOUT)
+		{
+			resetTimer = 0;
+			gw.printScore();
+			gw.reset();
+		}
+	}
+}
+
+SimThread::SimThread(GameWorld &gw, InputChannel *buttons)
+	: gw{gw}, buttons{buttons}
+{
+}
+
+SimThread::~SimThread()
+{
+	stop();
+}
+
+bool SimThread::start()
+{
+#ifdef __EMSCRIPTEN__
+	return false;
+#else
+	if (running())
+		return true;
+	// the first snapshot, so that there is one to draw right away
+	publish(InputClock::now());
+	quit = false;
+	worker = std::thread(&SimThread::run, this);
+	return true;
+#endif
+}
+
+void SimThread::stop()
+{
+	if (!running())
+		return;
+	quit = true;
+	worker.join();
+	if (reportInput)
+		keys.printStats("SDL");
+}
+
+const WorldSnapshot &SimThread::latest(double &alpha)
+{
+	published.update();
+	const Published &p = published.front();
+	std::chrono::duration<double, std::milli> since = InputClock::now() - p.time;
+	alpha = std::min(std::max(since.count() / GameWorld::STEP_MS, 0.0), 1.0);
+	return p.world;
+}
+
+void SimThread::publish(InputClock::time_point time)
+{
+	Published &p = published.back();
+	// the platforms of all three buffers are allocated once
+	p.world.platforms.reserve(PlatformRing::CAPACITY);
+	gw.snapshot(p.world);
+	p.time = time;
+	published.publish();
+}
+
+void SimThread::run()
+{
+	double resetTimer = 0;
+	StepClock clock(monotonicNs());
+	while (!quit)
+	{
+		InputClock::time_point now = InputClock::now();
+		clock.advance(monotonicNs());
+		bool stepped = false;
+		while (clock.stepDue())
+		{
+			clock.step();
+			InputClock::time_point until = now - std::chrono::nanoseconds(clock.leftoverNs());
+			if (buttons)
+				buttons->deliver(gw.input, until);
+			keys.deliver(gw.input, until);
+			playStep(gw, resetTimer);
+			stepped = true;
+		}
+		if (stepped)
+			publish(now - std::chrono::nanoseconds(clock.leftoverNs()));
+		std::this_thread::sleep_for(std::chrono::nanoseconds(clock.untilStepNs()));
+	}
+}
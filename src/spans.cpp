@@ -0,0 +1,93 @@
+#include "spans.hpp"
+#include "pixels.hpp"
+
+#include <algorithm>
+
+void SpanRenderer::add(const SDL_Rect &rect, Uint32 color)
+{
+	layers.push_back(Layer{rect.x, rect.y, rect.x + rect.w, rect.y + rect.h, color});
+}
+
+void SpanRenderer::render(SDL_Surface *dst, const SDL_Rect &area, Uint32 background)
+{
+	int left = area.x;
+	int top = area.y;
+	int right = area.x + area.w;
+	int bottom = area.y + area.h;
+
+	visible.clear();
+	edges.clear();
+	edges.push_back(top);
+	edges.push_back(bottom);
+	for (const Layer &l : layers)
+	{
+		Layer v = {std::max(l.x0, left), std::max(l.y0, top),
+			std::min(l.x1, right), std::min(l.y1, bottom), l.color};
+		if (v.x0 >= v.x1 || v.y0 >= v.y1)
+			continue;
+		visible.push_back(v);
+		edges.push_back(v.y0);
+		edges.push_back(v.y1);
+	}
+	std::sort(edges.begin(), edges.end());
+	edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+	// no rectangle starts or ends inside a band, so its spans hold for
+	// every scanline of it
+	for (size_t e = 0; e + 1 < edges.size(); ++e)
+	{
+		int y0 = edges[e];
+		int y1 = edges[e + 1];
+		covered.clear();
+		for (auto it = visible.rbegin(); it != visible.rend(); ++it)
+			if (it->y0 <= y0 && y1 <= it->y1)
+				fillUncovered(dst, it->x0, it->x1, y0, y1, it->color);
+		fillUncovered(dst, left, right, y0, y1, background);
+	}
+}
+
+// fills the parts of [x0, x1) no span of the band has taken yet, then
+// takes all of it
+void SpanRenderer::fillUncovered(SDL_Surface *dst, int x0, int x1, int y0, int y1, Uint32 color)
+{
+	int x = x0;
+	for (const Span &c : covered)
+	{
+		if (c.x1 <= x)
+			continue;
+		if (c.x0 >= x1)
+			break;
+		if (c.x0 > x)
+		{
+			SDL_Rect r = {.x = (Sint16)x, .y = (Sint16)y0, .w = (Uint16)(c.x0 - x), .h = (Uint16)(y1 - y0)};
+			fillRectLocked(dst, &r, color);
+		}
+		x = c.x1;
+		if (x >= x1)
+			break;
+	}
+	if (x < x1)
+	{
+		SDL_Rect r = {.x = (Sint16)x, .y = (Sint16)y0, .w = (Uint16)(x1 - x), .h = (Uint16)(y1 - y0)};
+		fillRectLocked(dst, &r, color);
+	}
+	cover(x0, x1);
+}
+
+void SpanRenderer::cover(int x0, int x1)
+{
+	// spans stay sorted and disjoint; the new one swallows every span it
+	// overlaps or touches
+	size_t i = 0;
+	while (i < covered.size() && covered[i].x1 < x0)
+		++i;
+	size_t j = i;
+	while (j < covered.size() && covered[j].x0 <= x1)
+	{
+		x0 = std::min(x0, covered[j].x0);
+		x1 = std::max(x1, covered[j].x1);
+		++j;
+	}
+	covered.erase(covered.begin() + i, covered.begin() + j);
+	covered.insert(covered.begin() + i, Span{x0, x1});
+}
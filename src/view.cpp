@@ -0,0 +1,346 @@
+#include "view.hpp"
+#include "pixels.hpp"
+
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <iostream>
+
+using std::cout;
+using std::endl;
+using std::string;
+
+static bool clipToScreen(SDL_Rect &r, const CollisionBox &box)
+{
+	int x0 = std::max(toInt(box.x), 0);
+	int y0 = std::max(toInt(box.y), 0);
+	int x1 = std::min(toInt(box.x + box.w), SCREEN_WIDTH);
+	int y1 = std::min(toInt(box.y + box.h), SCREEN_HEIGHT);
+	if (x0 >= x1 || y0 >= y1)
+		return false;
+	r = {.x = (Sint16)x0, .y = (Sint16)y0, .w = (Uint16)(x1 - x0), .h = (Uint16)(y1 - y0)};
+	return true;
+}
+
+static SDL_Rect unite(const SDL_Rect &a, const SDL_Rect &b)
+{
+	int x0 = std::min(a.x, b.x);
+	int y0 = std::min(a.y, b.y);
+	int x1 = std::max(a.x + a.w, b.x + b.w);
+	int y1 = std::max(a.y + a.h, b.y + b.h);
+	return {.x = (Sint16)x0, .y = (Sint16)y0, .w = (Uint16)(x1 - x0), .h = (Uint16)(y1 - y0)};
+}
+
+static bool operator==(const SDL_Rect &a, const SDL_Rect &b)
+{
+	return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+}
+
+GameView::GameView(GameWorld &gw, RenderPath renderPath)
+	: gw{gw}, dirtyRects{screenRetained()}, rasterizer{renderPath}
+{
+	sprites.reserve(PlatformRing::CAPACITY + 1);
+	shownSprites.reserve(PlatformRing::CAPACITY + 1);
+	dirty.reserve(2 * (PlatformRing::CAPACITY + 2));
+	shownMatched.reserve(PlatformRing::CAPACITY + 1);
+	snapshot.platforms.reserve(PlatformRing::CAPACITY);
+	overlayRect = {.x = GameWorld::WALL_WIDTH + 4, .y = SCREEN_HEIGHT - 12, .w = 0, .h = 0};
+	shownOverlayRect = overlayRect;
+	lastDrain = SDL_GetTicks();
+}
+
+void GameView::setOverlay(const string &text)
+{
+	if (text == overlay)
+		return;
+	overlay = text;
+	overlayChanged = true;
+}
+
+void GameView::record()
+{
+	buffer.clear();
+	buffer.background(backgroundColor);
+	SDL_Rect wall = {.x = 0, .y = 0, .w = GameWorld::WALL_WIDTH, .h = SCREEN_HEIGHT};
+	buffer.fill(wall, primaryColor);
+	wall.x = SCREEN_WIDTH - GameWorld::WALL_WIDTH;
+	buffer.fill(wall, primaryColor);
+	for (const Sprite &s : sprites)
+		buffer.fill(s.rect, s.color);
+	for (const Sprite &s : sprites)
+		if (s.label)
+			buffer.text(labelRun(s.label), s.labelX, s.labelY);
+	buffer.text(hudRun, hudRect.x, hudRect.y);
+	if (!overlay.empty())
+		buffer.text(overlayRun, overlayRect.x, overlayRect.y);
+}
+
+TextRun &GameView::labelRun(const char *label)
+{
+	// labels are string literals, one per biome, so the pointer is key
+	// enough; the few on screen at once never evict each other
+	for (LabelRun &l : labelRuns)
+		if (l.label == label)
+			return l.run;
+	LabelRun &l = labelRuns[nextLabelRun];
+	nextLabelRun = (nextLabelRun + 1) % LABEL_RUNS;
+	l.label = label;
+	return l.run;
+}
+
+Sprite GameView::platformSprite(const Platform &p, int key, const CollisionBox &box)
+{
+	Sprite s = {.key = key, .rect = {}, .color = primaryColor, .label = nullptr, .labelX = 0, .labelY = 0};
+	clipToScreen(s.rect, box);
+	if (p.label)
+	{
+		// blits are clipped, so a label scrolls off the screen together
+		// with its platform
+		labelRun(p.label).set(p.label, LABEL_FONT, secondaryColor);
+		s.label = p.label;
+		s.labelX = toInt(box.x) + GameWorld::WALL_WIDTH + 2;
+		s.labelY = toInt(box.y) + 2;
+	}
+	switch (p.kind)
+	{
+		case PK_DISAPPEARING:
+			s.color = palette.fade(p.fade());
+			break;
+		case PK_ELEVATOR:
+			s.color = palette.elevator();
+			break;
+		default:
+			break;
+	}
+	return s;
+}
+
+void GameView::collectSprites(const WorldSnapshot &world, double alpha)
+{
+	sprites.clear();
+	SDL_Rect r;
+	for (const WorldSnapshot::Item &item : world.platforms)
+	{
+		CollisionBox box = item.box.interpolate(item.prevBox, alpha);
+		if (clipToScreen(r, box))
+			sprites.push_back(platformSprite(item.platform, item.key, box));
+	}
+	if (clipToScreen(r, world.player.interpolate(world.prevPlayer, alpha)))
+		sprites.push_back(Sprite{.key = PLAYER_KEY, .rect = r, .color = playerColor, .label = nullptr, .labelX = 0, .labelY = 0});
+
+	hudChanged = world.floorNo != hudFloor || world.hiscore != hudHiscore;
+	if (hudChanged)
+	{
+		hudFloor = world.floorNo;
+		hudHiscore = world.hiscore;
+		hud = std::to_string(hudFloor) + "/" + std::to_string(hudHiscore);
+	}
+	hudRun.set(hud.c_str(), HUD_FONT, primaryColor);
+	hudRect.x = SCREEN_WIDTH - (hud.length() + 1) * 8;
+	hudRect.y = 4;
+	hudRect.w = hudRun.width();
+	hudRect.h = hudRun.height();
+
+	overlayRect.w = 0;
+	overlayRect.h = 0;
+	if (!overlay.empty())
+	{
+		overlayRun.set(overlay.c_str(), HUD_FONT, primaryColor);
+		overlayRect.w = overlayRun.width();
+		overlayRect.h = overlayRun.height();
+	}
+}
+
+void GameView::findDirtyRects()
+{
+	// a sprite that moved or changed colour dirties both where it was
+	// and where it is now
+	dirty.clear();
+	std::vector<char> &matched = shownMatched;
+	matched.assign(shownSprites.size(), false);
+	for (const Sprite &s : sprites)
+	{
+		bool found = false;
+		for (size_t i = 0; i < shownSprites.size(); ++i)
+		{
+			const Sprite &old = shownSprites[i];
+			if (old.key != s.key || matched[i])
+				continue;
+			matched[i] = true;
+			found = true;
+			if (!(old.rect == s.rect) || old.color != s.color || old.label != s.label)
+				dirty.push_back(unite(old.rect, s.rect));
+			break;
+		}
+		if (!found)
+			dirty.push_back(s.rect);
+	}
+	for (size_t i = 0; i < shownSprites.size(); ++i)
+		if (!matched[i])
+			dirty.push_back(shownSprites[i].rect);
+	if (hudChanged)
+		dirty.push_back(unite(shownHudRect, hudRect));
+	if (overlayChanged)
+		dirty.push_back(unite(shownOverlayRect, overlayRect));
+}
+
+void GameView::draw(double alpha)
+{
+	prepare(alpha);
+	present();
+}
+
+void GameView::draw(const WorldSnapshot &world, double alpha)
+{
+	prepare(world, alpha);
+	present();
+}
+
+void GameView::prepare(double alpha)
+{
+	gw.snapshot(snapshot);
+	prepare(snapshot, alpha);
+}
+
+void GameView::prepare(const WorldSnapshot &world, double alpha)
+{
+	palette.update();
+	Uint32 background = palette.background(world.travelledDistance);
+	fullRedraw = !dirtyRects || !painted ||
+		background != backgroundColor || primaryColor != shownPrimary;
+	backgroundColor = background;
+	collectSprites(world, alpha);
+	record();
+	if (!fullRedraw)
+		findDirtyRects();
+}
+
+void GameView::present()
+{
+	rasterize();
+	show();
+}
+
+void GameView::rasterize()
+{
+	if (fullRedraw)
+	{
+		rasterizer.execute(buffer, screen, nullptr);
+		return;
+	}
+	for (SDL_Rect &d : dirty)
+	{
+		SDL_SetClipRect(screen, &d);
+		rasterizer.execute(buffer, screen, &d);
+	}
+	SDL_SetClipRect(screen, NULL);
+}
+
+void GameView::show()
+{
+	if (fullRedraw)
+		presentScreen();
+	else if (!dirty.empty())
+		presentScreen(dirty.size(), dirty.data());
+
+	painted = true;
+	shownPrimary = primaryColor;
+	std::swap(sprites, shownSprites);
+	shownHudRect = hudRect;
+	shownOverlayRect = overlayRect;
+	overlayChanged = false;
+}
+
+void GameView::handleEvents()
+{
+	SDL_Event event;
+	bool handled = false;
+	Uint32 oldest = 0;
+
+	while (SDL_PollEvent(&event))
+	{
+#ifdef USE_SDL2
+		if (!handled || SDL_TICKS_PASSED(oldest, event.common.timestamp))
+			oldest = event.common.timestamp;
+#endif
+		handled = true;
+		++inputEvents;
+		switch (event.type)
+		{
+			case SDL_KEYUP:
+			case SDL_KEYDOWN:
+			{
+				bool down = event.type == SDL_KEYDOWN;
+				switch (event.key.keysym.sym)
+				{
+					case SDLK_LEFT:
+						steer(IB_LEFT, down);
+						break;
+					case SDLK_RIGHT:
+						steer(IB_RIGHT, down);
+						break;
+					case SDLK_SPACE:
+						steer(IB_JUMP, down);
+						break;
+					case SDLK_RETURN:
+#ifdef USE_SDL2
+						// SDL2 repeats held keys
+						if (event.key.repeat)
+							break;
+#endif
+						if (down)
+							switchColors();
+						break;
+					case SDLK_ESCAPE:
+						if (down)
+						{
+							SDL_Event ev;
+							ev.type = SDL_QUIT;
+							SDL_PushEvent(&ev);
+						}
+						break;
+				}
+				break;
+			}
+			case SDL_QUIT:
+				if (reportInput)
+					printInputStats();
+				throw EC_QUIT;
+				break;
+		}
+	}
+
+	Uint32 now = SDL_GetTicks();
+#ifndef USE_SDL2
+	// SDL 1.2 events carry no timestamp; the oldest one can have waited
+	// since the queue was last drained
+	oldest = lastDrain;
+#endif
+	lastDrain = now;
+	++inputFrames;
+	if (!handled)
+		return;
+	Uint32 age = now - oldest;
+	inputAgeTotal += age;
+	inputAgeMax = std::max(inputAgeMax, age);
+	++inputFramesWithEvents;
+}
+
+void GameView::steer(InputButton button, bool down)
+{
+	if (!steerFromEvents)
+		return;
+	if (keyChannel)
+		keyChannel->post({InputClock::now(), button, down});
+	else
+		gw.input.set(button, down);
+}
+
+void GameView::printInputStats() const
+{
+	cout << inputEvents << " events in " << inputFrames << " frames";
+	if (inputFramesWithEvents)
+		cout << ", oldest event handled after " << (double)inputAgeTotal / inputFramesWithEvents
+			<< " ms on average, " << inputAgeMax << " ms at most";
+	cout << endl;
+}